@@ -0,0 +1,285 @@
+#include <algorithm>
+#include "translator.hh"
+#include "interpreter.hh"
+using namespace std;
+
+// <algorithm> and <numeric> over the cells of vectors and arrays.
+//
+// Ranges of 'int' or 'double' are first unboxed into a contiguous buffer
+// so that the kernels below are plain loops over native values (which the
+// compiler vectorizes); ranges of other types work on the Values. 'find' 
+// and 'count' only read each cell once, so they compare the cells in place
+// (and 'find' stops at the first match).
+
+static void _fail(string msg) {
+   throw new EvalError(msg);
+}
+
+struct CellRange {
+   vector<Value> *cells;
+   int ini, fin;
+   Value& operator[](int i) const { return (*cells)[i]; }
+};
+
+static CellRange range(string func, const vector<Value>& args, int nargs) {
+   if (args.size() != nargs) {
+      _fail(_T("Error en el número de argumentos al llamar a '%s'", func.c_str()));
+   }
+   IterValue a, b;
+   if (!Iterator::get(Reference::deref(args[0]), a) or
+       !Iterator::get(Reference::deref(args[1]), b)) {
+      _fail(_T("'%s' necesita dos iteradores", func.c_str()));
+   }
+   if (a.cells != b.cells or a.pos < 0 or a.pos > b.pos or b.pos > a.cells->size()) {
+      _fail(_T("El rango pasado a '%s' no es válido", func.c_str()));
+   }
+   return CellRange{a.cells, a.pos, b.pos};
+}
+
+template<class T>
+static bool unbox(const CellRange& r, vector<typename T::cpp_type>& vals) {
+   vals.reserve(r.fin - r.ini);
+   for (int i = r.ini; i < r.fin; i++) {
+      const Value& c = r[i];
+      if (c.type() != T::self or c.data() == 0) {
+         return false;
+      }
+      vals.push_back(T::cast(c.data()));
+   }
+   return true;
+}
+
+template<class T>
+static void rebox(const CellRange& r, const vector<typename T::cpp_type>& vals) {
+   for (int i = r.ini; i < r.fin; i++) {
+      T::cast(r[i].data()) = vals[i - r.ini];
+   }
+}
+
+// Kernels
+
+template<typename T>
+static T sum_of(const T *p, int n, T acc) {
+   for (int i = 0; i < n; i++) {
+      acc += p[i];
+   }
+   return acc;
+}
+
+template<typename T, class Cmp>
+static int extreme_of(const T *p, int n, Cmp better) { // first min or max
+   int k = 0;
+   for (int i = 1; i < n; i++) {
+      if (better(p[i], p[k])) {
+         k = i;
+      }
+   }
+   return k;
+}
+
+// Values
+
+// Whether cell 'c' equals 'x' (of type T, with value 'v'), natively when
+// 'c' is also a T
+template<class T>
+static bool cell_equals(const Value& c, typename T::cpp_type v, const Value& x) {
+   if (c.type() == T::self and c.data() != 0) {
+      return T::cast(c.data()) == v;
+   }
+   return c.equals(x);
+}
+
+template<class T>
+static int find_cell(const CellRange& r, const Value& x) {
+   const typename T::cpp_type v = T::cast(x.data());
+   int i = r.ini;
+   while (i < r.fin and !cell_equals<T>(r[i], v, x)) {
+      i++;
+   }
+   return i;
+}
+
+template<class T>
+static int count_cells(const CellRange& r, const Value& x) {
+   const typename T::cpp_type v = T::cast(x.data());
+   int k = 0;
+   for (int i = r.ini; i < r.fin; i++) {
+      k += cell_equals<T>(r[i], v, x);
+   }
+   return k;
+}
+
+static bool value_less(const Value& a, const Value& b) {
+   if (!a.same_type_as(b) or a.data() == 0 or b.data() == 0) {
+      _fail(_T("Los elementos no se pueden comparar"));
+   }
+   if (a.is<Int>())    { return a.as<Int>()    < b.as<Int>(); }
+   if (a.is<Double>()) { return a.as<Double>() < b.as<Double>(); }
+   if (a.is<Float>())  { return a.as<Float>()  < b.as<Float>(); }
+   if (a.is<Char>())   { return a.as<Char>()   < b.as<Char>(); }
+   if (a.is<String>()) { return a.as<String>() < b.as<String>(); }
+   if (a.is<Bool>())   { return a.as<Bool>()   < b.as<Bool>(); }
+   _fail(_T("Los elementos de tipo '%s' no se pueden comparar", a.type_name().c_str()));
+   return false;
+}
+
+// Builtins
+
+Value _sort(const vector<Value>& args) {
+   CellRange r = range("sort", args, 2);
+   vector<int> ints;
+   vector<double> doubles;
+   if (unbox<Int>(r, ints)) {
+      sort(ints.begin(), ints.end());
+      rebox<Int>(r, ints);
+   } else if (unbox<Double>(r, doubles)) {
+      sort(doubles.begin(), doubles.end());
+      rebox<Double>(r, doubles);
+   } else {
+      stable_sort(r.cells->begin() + r.ini, r.cells->begin() + r.fin, value_less);
+   }
+   return Value::null;
+}
+
+Value _reverse(const vector<Value>& args) {
+   CellRange r = range("reverse", args, 2);
+   reverse(r.cells->begin() + r.ini, r.cells->begin() + r.fin);
+   return Value::null;
+}
+
+Value _find(const vector<Value>& args) {
+   CellRange r = range("find", args, 3);
+   Value x = Reference::deref(args[2]);
+   int i;
+   if (x.is<Int>() and x.data() != 0) {
+      i = find_cell<Int>(r, x);
+   } else if (x.is<Double>() and x.data() != 0) {
+      i = find_cell<Double>(r, x);
+   } else {
+      i = r.ini;
+      while (i < r.fin and !r[i].equals(x)) {
+         i++;
+      }
+   }
+   return Iterator::self->mkvalue(r.cells, i);
+}
+
+Value _count(const vector<Value>& args) {
+   CellRange r = range("count", args, 3);
+   Value x = Reference::deref(args[2]);
+   if (x.is<Int>() and x.data() != 0) {
+      return Value(count_cells<Int>(r, x));
+   }
+   if (x.is<Double>() and x.data() != 0) {
+      return Value(count_cells<Double>(r, x));
+   }
+   int k = 0;
+   for (int i = r.ini; i < r.fin; i++) {
+      k += r[i].equals(x);
+   }
+   return Value(k);
+}
+
+Value _accumulate(const vector<Value>& args) {
+   CellRange r = range("accumulate", args, 3);
+   Value init = Reference::deref(args[2]);
+   if (init.data() == 0) {
+      _fail(_T("El valor inicial de '%s' no está inicializado", "accumulate"));
+   }
+   vector<int> ints;
+   vector<double> doubles;
+   if (init.is<Int>() and unbox<Int>(r, ints)) {
+      return Value(sum_of(ints.data(), ints.size(), init.as<Int>()));
+   }
+   if (init.is<Double>() and unbox<Double>(r, doubles)) {
+      return Value(sum_of(doubles.data(), doubles.size(), init.as<Double>()));
+   }
+   if (init.is<Double>() and unbox<Int>(r, ints)) {
+      double acc = init.as<Double>();
+      for (int x : ints) {
+         acc += x;
+      }
+      return Value(acc);
+   }
+   if (init.is<Int>() and unbox<Double>(r, doubles)) {
+      int acc = init.as<Int>(); // (each partial sum is an int, as in C++)
+      for (double x : doubles) {
+         acc = int(acc + x);
+      }
+      return Value(acc);
+   }
+   if (init.is<String>()) {
+      string acc = init.as<String>();
+      for (int i = r.ini; i < r.fin; i++) {
+         if (!r[i].is<String>() or r[i].data() == 0) {
+            _fail(_T("Los elementos no se pueden sumar a un '%s'", "string"));
+         }
+         acc += r[i].as<String>();
+      }
+      return Value(acc);
+   }
+   _fail(_T("Los elementos no se pueden sumar a un '%s'", init.type_name().c_str()));
+   return Value::null;
+}
+
+template<class Better>
+Value _extreme_element(string func, const vector<Value>& args) {
+   CellRange r = range(func, args, 2);
+   if (r.ini == r.fin) {
+      return Iterator::self->mkvalue(r.cells, r.fin);
+   }
+   vector<int> ints;
+   vector<double> doubles;
+   int k = 0;
+   if (unbox<Int>(r, ints)) {
+      k = extreme_of(ints.data(), ints.size(), Better());
+   } else if (unbox<Double>(r, doubles)) {
+      k = extreme_of(doubles.data(), doubles.size(), Better());
+   } else {
+      for (int i = 1; i < r.fin - r.ini; i++) {
+         if (Better::values(r[r.ini + i], r[r.ini + k])) {
+            k = i;
+         }
+      }
+   }
+   return Iterator::self->mkvalue(r.cells, r.ini + k);
+}
+
+struct _Smaller {
+   template<typename T> bool operator()(T a, T b) const { return a < b; }
+   static bool values(const Value& a, const Value& b) { return value_less(a, b); }
+};
+
+struct _Bigger {
+   template<typename T> bool operator()(T a, T b) const { return b < a; }
+   static bool values(const Value& a, const Value& b) { return value_less(b, a); }
+};
+
+Value _min_element(const vector<Value>& args) {
+   return _extreme_element<_Smaller>("min_element", args);
+}
+
+Value _max_element(const vector<Value>& args) {
+   return _extreme_element<_Bigger>("max_element", args);
+}
+
+void Interpreter::prepare_algorithms() {
+   struct {
+      const char *name;
+      Type *return_type;
+      BuiltinFunc::Ptr func;
+   } builtins[] = {
+      { "sort",        0,              _sort        },
+      { "reverse",     0,              _reverse     },
+      { "find",        Iterator::self, _find        },
+      { "count",       Int::self,      _count       },
+      { "accumulate",  0,              _accumulate  }, // (the type of 'init')
+      { "min_element", Iterator::self, _min_element },
+      { "max_element", Iterator::self, _max_element },
+   };
+   const bool hidden = true;
+   for (auto& b : builtins) {
+      Function *type = new Function(b.return_type, true);
+      setenv(b.name, type->mkvalue(b.name, new BuiltinFunc(b.func)), hidden);
+   }
+}
@@ -0,0 +1,406 @@
+#include "annotator.hh"
+#include "types.hh"
+using namespace std;
+
+// Only types that do not depend on the program (struct types, for
+// instance, are created by the Interpreter as it runs) and never the
+// Reference itself, since expressions are annotated dereferenced.
+const Type *TypeAnnotator::typespec_type(TypeSpec *spec) {
+   if (spec == 0 or spec->id == 0 or !spec->id->prefix.empty()) {
+      return 0;
+   }
+   for (TypeSpec *sub : spec->id->subtypes) {
+      if (typespec_type(sub) == 0) {
+         return 0;
+      }
+   }
+   const Type *t = Type::get(spec);
+   if (t != 0 and t->is<Reference>()) {
+      t = t->as<Reference>()->subtype();
+   }
+   if (t != 0 and t->is<Vector>() and t->as<Vector>()->celltype() == 0) {
+      return 0; // the template itself
+   }
+   return t;
+}
+
+static bool is_var(Expr *x, string name);
+
+const Type *TypeAnnotator::lookup(string name) {
+   for (int i = _scopes.size()-1; i >= 0; i--) {
+      auto it = _scopes[i].find(name);
+      if (it != _scopes[i].end()) {
+         return it->second;
+      }
+   }
+   return 0;
+}
+
+void TypeAnnotator::declare(string name, const Type *t) {
+   _scopes.back()[name] = t;
+}
+
+const Type *TypeAnnotator::annotate(Expr *x) {
+   _type = 0;
+   if (x != 0) {
+      x->accept(this);
+      x->static_type = _type;
+   }
+   return _type;
+}
+
+void TypeAnnotator::visit_program(Program *x) {
+   _scopes.clear();
+   _scopes.push_back(Scope());
+   for (AstNode *n : x->nodes) {
+      FuncDecl *f = dynamic_cast<FuncDecl*>(n);
+      if (f != 0 and f->return_typespec != 0) {
+         _funcs[f->funcname()] = typespec_type(f->return_typespec);
+      }
+   }
+   for (AstNode *n : x->nodes) {
+      n->accept(this);
+   }
+}
+
+void TypeAnnotator::visit_funcdecl(FuncDecl *x) {
+   if (x->block == 0) {
+      return;
+   }
+   _scopes.push_back(Scope());
+   for (ParamDecl *p : x->params) {
+      declare(p->name, typespec_type(p->typespec));
+   }
+   x->block->accept(this);
+   _scopes.pop_back();
+}
+
+void TypeAnnotator::visit_block(Block *x) {
+   _scopes.push_back(Scope());
+   for (Stmt *s : x->stmts) {
+      s->accept(this);
+   }
+   _scopes.pop_back();
+}
+
+void TypeAnnotator::visit_declstmt(DeclStmt *x) {
+   const Type *t = typespec_type(x->typespec);
+   for (DeclStmt::Item& item : x->items) {
+      annotate(item.init);
+      const Type *vartype = t;
+      if (item.decl->is<ArrayDecl>()) {
+         ArrayDecl *a = dynamic_cast<ArrayDecl*>(item.decl);
+         vector<int> dims;
+         for (int k = 0; k <= a->subsizes.size(); k++) {
+            Expr *size_expr = (k == 0 ? a->size : a->subsizes[k-1]);
+            Literal *size = dynamic_cast<Literal*>(size_expr);
+            annotate(size_expr);
+            if (size != 0 and size->type == Literal::Int and size->val.as_int > 0) {
+               dims.push_back(size->val.as_int);
+            }
+         }
+         vartype = 0;
+         if (t != 0 and dims.size() == 1 + a->subsizes.size()) {
+            Type *celltype = const_cast<Type*>(t);
+            vartype = (dims.size() == 1 
+                       ? (Type*)Array::mkarray(celltype, dims[0])
+                       : (Type*)MultiArray::mkarray(celltype, dims));
+         }
+      } else if (item.decl->is<ObjDecl>()) {
+         for (Expr *arg : dynamic_cast<ObjDecl*>(item.decl)->args) {
+            annotate(arg);
+         }
+      } else if (dynamic_cast<VarDecl*>(item.decl)->kind == Decl::Pointer) {
+         vartype = 0;
+      }
+      declare(item.decl->name, vartype);
+   }
+}
+
+void TypeAnnotator::visit_exprstmt(ExprStmt *x) {
+   annotate(x->expr);
+}
+
+void TypeAnnotator::visit_ifstmt(IfStmt *x) {
+   annotate(x->cond);
+   x->then->accept(this);
+   if (x->els) {
+      x->els->accept(this);
+   }
+}
+
+void TypeAnnotator::visit_iterstmt(IterStmt *x) {
+   _scopes.push_back(Scope());
+   if (x->init) {
+      x->init->accept(this);
+   }
+   annotate(x->cond);
+   annotate(x->post);
+   x->substmt->accept(this);
+   _scopes.pop_back();
+   x->counted.reset(x->is_for() ? counted_loop(x) : 0);
+}
+
+void TypeAnnotator::visit_switchstmt(SwitchStmt *x) {
+   annotate(x->cond);
+   _scopes.push_back(Scope());
+   for (SwitchStmt::Case& c : x->cases) {
+      annotate(c.label);
+      for (Stmt *s : c.stmts) {
+         s->accept(this);
+      }
+   }
+   _scopes.pop_back();
+}
+
+// Whether a declaration of 'name' appears in x (which would replace the
+// variable in the loop's environment)
+static bool declares(Stmt *x, string name) {
+   if (x == 0) {
+      return false;
+   }
+   if (x->is<DeclStmt>()) {
+      for (DeclStmt::Item& item : dynamic_cast<DeclStmt*>(x)->items) {
+         if (item.decl->name == name) {
+            return true;
+         }
+      }
+   } else if (x->is<Block>()) {
+      for (Stmt *stmt : dynamic_cast<Block*>(x)->stmts) {
+         if (declares(stmt, name)) {
+            return true;
+         }
+      }
+   } else if (x->is<IfStmt>()) {
+      IfStmt *ifs = dynamic_cast<IfStmt*>(x);
+      return declares(ifs->then, name) or declares(ifs->els, name);
+   } else if (x->is<IterStmt>()) {
+      IterStmt *it = dynamic_cast<IterStmt*>(x);
+      return declares(it->init, name) or declares(it->substmt, name);
+   } else if (x->is<SwitchStmt>()) {
+      for (SwitchStmt::Case& c : dynamic_cast<SwitchStmt*>(x)->cases) {
+         for (Stmt *stmt : c.stmts) {
+            if (declares(stmt, name)) {
+               return true;
+            }
+         }
+      }
+   }
+   return false;
+}
+
+static bool is_var(Expr *x, string name) {
+   Ident *id = dynamic_cast<Ident*>(x);
+   return id != 0 and id->prefix.empty() and id->name == name;
+}
+
+IterStmt::Counted *TypeAnnotator::counted_loop(IterStmt *x) {
+   DeclStmt *init = dynamic_cast<DeclStmt*>(x->init);
+   if (init == 0 or init->items.size() != 1 or init->typespec->reference or
+       typespec_type(init->typespec) != Int::self) {
+      return 0;
+   }
+   VarDecl *var = dynamic_cast<VarDecl*>(init->items[0].decl);
+   if (var == 0 or var->kind != Decl::Normal or declares(x->substmt, var->name)) {
+      return 0;
+   }
+   BinaryExpr *cond = dynamic_cast<BinaryExpr*>(x->cond);
+   if (cond == 0 or !(cond->op == "<" or cond->op == "<=" or cond->op == "!=") or
+       !is_var(cond->left, var->name) or cond->right->static_type != Int::self) {
+      return 0;
+   }
+   int step = 0;
+   if (x->post->is<IncrExpr>()) {
+      IncrExpr *incr = dynamic_cast<IncrExpr*>(x->post);
+      if (is_var(incr->expr, var->name)) {
+         step = (incr->kind == IncrExpr::Positive ? 1 : -1);
+      }
+   } else if (x->post->is<BinaryExpr>()) {
+      BinaryExpr *post = dynamic_cast<BinaryExpr*>(x->post);
+      Literal *k = dynamic_cast<Literal*>(post->right);
+      if ((post->op == "+=" or post->op == "-=") and is_var(post->left, var->name) and
+          k != 0 and k->type == Literal::Int) {
+         step = (post->op == "+=" ? k->val.as_int : -k->val.as_int);
+      }
+   }
+   if (step == 0) {
+      return 0;
+   }
+   IterStmt::Counted *c = new IterStmt::Counted();
+   c->var  = var->name;
+   c->cmp  = (cond->op == "<"  ? IterStmt::Counted::Lt :
+              cond->op == "<=" ? IterStmt::Counted::Le : IterStmt::Counted::Ne);
+   c->step = step;
+   return c;
+}
+
+void TypeAnnotator::visit_ident(Ident *x) {
+   _type = (x->prefix.empty() ? lookup(x->name) : 0);
+}
+
+void TypeAnnotator::visit_literal(Literal *x) {
+   switch (x->type) {
+   case Literal::String: _type = String::self; break;
+   case Literal::Int:    _type = Int::self;    break;
+   case Literal::Double: _type = Double::self; break;
+   case Literal::Bool:   _type = Bool::self;   break;
+   case Literal::Char:   _type = Char::self;   break;
+   default:              _type = 0;
+   }
+}
+
+// Result of the operators the Interpreter evaluates without conversions
+const Type *TypeAnnotator::binaryexpr_type(BinaryExpr *x, const Type *left, const Type *right) {
+   if (left == 0 or right == 0) {
+      return 0;
+   }
+   if (x->kind == Expr::Assignment) {
+      return left;
+   }
+   if (left != right) {
+      return 0;
+   }
+   const string& op = x->op;
+   const bool num = (left == Int::self or left == Float::self or left == Double::self);
+   if (op == "+") {
+      return (num or left == String::self ? left : 0);
+   }
+   if (op == "-" or op == "*" or op == "/") {
+      return (num ? left : 0);
+   }
+   if (op == "%" or op == "&" or op == "|" or op == "^") {
+      return (left == Int::self ? left : 0);
+   }
+   if (op == "<" or op == ">" or op == "<=" or op == ">=") {
+      return (num or left == String::self ? Bool::self : 0);
+   }
+   if (op == "==" or op == "!=") {
+      return Bool::self;
+   }
+   if (op == "&&" or op == "and" or op == "||" or op == "or") {
+      return (left == Bool::self ? left : 0);
+   }
+   return 0;
+}
+
+void TypeAnnotator::visit_binaryexpr(BinaryExpr *x) {
+   const Type *left  = annotate(x->left);
+   const Type *right = annotate(x->right);
+   _type = binaryexpr_type(x, left, right);
+   if (x->op == "=") {
+      x->inplace = inplace_assignment(x);
+   }
+}
+
+// 's = s + x' for any variable (its type is checked as it runs) and
+// 's[i] = c' for a string variable
+BinaryExpr::InPlace TypeAnnotator::inplace_assignment(BinaryExpr *x) {
+   Ident *var = dynamic_cast<Ident*>(x->left);
+   BinaryExpr *sum = dynamic_cast<BinaryExpr*>(x->right);
+   if (var != 0 and sum != 0 and sum->op == "+" and is_var(sum->left, var->name)) {
+      return BinaryExpr::Append;
+   }
+   IndexExpr *cell = dynamic_cast<IndexExpr*>(x->left);
+   if (cell != 0 and cell->base->is<Ident>() and cell->base->static_type == String::self) {
+      return BinaryExpr::StoreChar;
+   }
+   return BinaryExpr::NotInPlace;
+}
+
+void TypeAnnotator::visit_callexpr(CallExpr *x) {
+   annotate(x->func);
+   for (Expr *arg : x->args) {
+      annotate(arg);
+   }
+   _type = 0;
+   Ident *id = dynamic_cast<Ident*>(x->func);
+   if (id != 0 and lookup(id->name) == 0) {
+      auto it = _funcs.find(id->name);
+      if (it != _funcs.end()) {
+         _type = it->second;
+      } else if (id->name == "accumulate" and x->args.size() == 3) {
+         // the builtin gives a value of the type of its 'init'
+         const Type *init = x->args[2]->static_type;
+         if (init == Int::self or init == Double::self or init == String::self) {
+            _type = init;
+         }
+      }
+   }
+}
+
+void TypeAnnotator::visit_indexexpr(IndexExpr *x) {
+   const Type *base = annotate(x->base);
+   annotate(x->index);
+   IndexExpr *inner = dynamic_cast<IndexExpr*>(x->base);
+   if (inner != 0 and inner->chain < IndexExpr::MaxChain) {
+      x->chain = (inner->chain > 0 ? inner->chain + 1 : 0);
+   } else if (x->base->is<Ident>()) {
+      x->chain = 1;
+   }
+   _type = 0;
+   if (base == String::self) {
+      _type = Char::self;
+   } else if (base != 0 and base->is<Vector>()) {
+      _type = base->as<Vector>()->celltype();
+   } else if (base != 0 and base->is<Array>()) {
+      _type = base->as<Array>()->celltype();
+   } else if (base != 0 and base->is<MultiArray>()) {
+      _type = base->as<MultiArray>()->rowtype();
+   }
+}
+
+void TypeAnnotator::visit_fieldexpr(FieldExpr *x) {
+   annotate(x->base);
+   _type = 0;
+}
+
+void TypeAnnotator::visit_condexpr(CondExpr *x) {
+   annotate(x->cond);
+   const Type *then = annotate(x->then);
+   const Type *els  = annotate(x->els);
+   _type = (then == els ? then : 0);
+}
+
+void TypeAnnotator::visit_exprlist(ExprList *x) {
+   const Type *last = 0;
+   for (Expr *e : x->exprs) {
+      last = annotate(e);
+   }
+   _type = last;
+}
+
+void TypeAnnotator::visit_signexpr(SignExpr *x) {
+   const Type *t = annotate(x->expr);
+   _type = (t == Int::self or t == Float::self or t == Double::self ? t : 0);
+}
+
+void TypeAnnotator::visit_increxpr(IncrExpr *x) {
+   const Type *t = annotate(x->expr);
+   _type = (t == Int::self ? t : 0);
+}
+
+void TypeAnnotator::visit_negexpr(NegExpr *x) {
+   const Type *t = annotate(x->expr);
+   _type = (t == Bool::self ? t : 0);
+}
+
+void TypeAnnotator::visit_addrexpr(AddrExpr *x) {
+   annotate(x->expr);
+   _type = 0;
+}
+
+void TypeAnnotator::visit_derefexpr(DerefExpr *x) {
+   annotate(x->expr);
+   _type = 0;
+}
+
+void TypeAnnotator::visit_newexpr(NewExpr *x) {
+   annotate(x->size);
+   annotate(x->init);
+   _type = 0;
+}
+
+void TypeAnnotator::visit_deleteexpr(DeleteExpr *x) {
+   annotate(x->expr);
+   _type = 0;
+}
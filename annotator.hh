@@ -0,0 +1,71 @@
+#ifndef ANNOTATOR_HH
+#define ANNOTATOR_HH
+
+#include <assert.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "ast.hh"
+
+// The TypeAnnotator writes on each Expr the (dereferenced) runtime Type
+// it will evaluate to, whenever that follows from the declarations
+// alone (Expr::static_type, 0 means "unknown"). The Interpreter uses it
+// to pick its pre-typed evaluation paths from the first execution; since
+// lookup is dynamic at runtime, every such path still checks the actual
+// type and falls back to the generic one on a mismatch. It also marks
+// the counted int loops (IterStmt::Counted) and the string assignments
+// done in place (BinaryExpr::inplace).
+
+class TypeAnnotator : public AstVisitor {
+   typedef std::map<std::string, const Type*> Scope;
+   std::vector<Scope> _scopes;                 // _scopes[0] is the global scope
+   std::map<std::string, const Type*> _funcs; // return types
+   const Type *_type;                          // type of the last expression
+
+   const Type *typespec_type(TypeSpec *spec);
+   const Type *lookup(std::string name);
+         void  declare(std::string name, const Type *t);
+   const Type *annotate(Expr *x);               // visit and annotate x
+   const Type *binaryexpr_type(BinaryExpr *x, const Type *left, const Type *right);
+   IterStmt::Counted *counted_loop(IterStmt *x);
+   BinaryExpr::InPlace inplace_assignment(BinaryExpr *x);
+
+public:
+   TypeAnnotator() : _type(0) {}
+
+   void visit_program(Program *x);
+   void visit_include(Include *x)         {}
+   void visit_macro(Macro *x)             {}
+   void visit_using(Using *x)             {}
+   void visit_funcdecl(FuncDecl *x);
+   void visit_structdecl(StructDecl *x)   {}
+   void visit_typedefdecl(TypedefDecl *x) {}
+   void visit_enumdecl(EnumDecl *x)       {}
+   void visit_block(Block *x);
+   void visit_declstmt(DeclStmt *x);
+   void visit_exprstmt(ExprStmt *x);
+   void visit_ifstmt(IfStmt *x);
+   void visit_iterstmt(IterStmt *x);
+   void visit_switchstmt(SwitchStmt *x);
+   void visit_jumpstmt(JumpStmt *x)       {}
+   void visit_errorstmt(Stmt::Error *x)   {}
+
+   void visit_ident(Ident *x);
+   void visit_literal(Literal *x);
+   void visit_binaryexpr(BinaryExpr *x);
+   void visit_callexpr(CallExpr *x);
+   void visit_indexexpr(IndexExpr *x);
+   void visit_fieldexpr(FieldExpr *x);
+   void visit_condexpr(CondExpr *x);
+   void visit_exprlist(ExprList *x);
+   void visit_signexpr(SignExpr *x);
+   void visit_increxpr(IncrExpr *x);
+   void visit_negexpr(NegExpr *x);
+   void visit_addrexpr(AddrExpr *x);
+   void visit_derefexpr(DerefExpr *x);
+   void visit_newexpr(NewExpr *x);
+   void visit_deleteexpr(DeleteExpr *x);
+   void visit_errorexpr(Expr::Error *x)   { _type = 0; }
+};
+
+#endif
@@ -38,7 +38,7 @@ struct {
    { "and", Token::And,          Expr::LogicalAnd },
    { "&&",  Token::AmpAmp,       Expr::LogicalAnd },
 
-   { "|",   Token::Bar,          Expr::BitOr },
+   { "|",   Token::Pipe,         Expr::BitOr },
    { "^",   Token::Circum,       Expr::BitXor },
    { "&",   Token::Amp,          Expr::BitAnd },
 
@@ -58,7 +58,7 @@ struct {
 
    { "*",   Token::Star,         Expr::Multiplicative },
    { "/",   Token::Slash,        Expr::Multiplicative },
-   { "%",   Token::Div,          Expr::Multiplicative },
+   { "%",   Token::Percent,      Expr::Multiplicative },
 
    // { "->*", Expr::multiplicative }, TODO
    // { ".*", Expr::multiplicative }, TODO
@@ -72,7 +72,7 @@ const string TypeSpec::QualifiersNames[] = {
 };
 
 map<string, Expr::Kind>      Expr::_op2kind;
-map<Token::Kind, Expr::Kind> Expr::_tok2kind;
+Expr::Kind                   Expr::_tok2kind[Token::Unknown + 1];
 Expr::Op2KindInitializer Expr::initializer;
 
 Expr::Op2KindInitializer::Op2KindInitializer() {
@@ -89,11 +89,6 @@ Expr::Kind Expr::op2kind(string op) {
    return (it != _op2kind.end() ? it->second : Expr::Unknown);
 }
 
-Expr::Kind Expr::tok2kind(Token::Kind tokkind) {
-   auto it = _tok2kind.find(tokkind);
-   return (it != _tok2kind.end() ? it->second : Expr::Unknown);
-}
-
 bool Expr::right_associative(Expr::Kind t) {
    return t == Expr::Assignment;
 }
@@ -126,6 +121,15 @@ JumpStmt::Kind JumpStmt::keyword2type(string s) {
    }
 }
 
+int SwitchStmt::Table::find(int val) const {
+   if (!jump.empty()) {
+      const unsigned i = unsigned(val) - unsigned(min); // (one comparison)
+      return (i < jump.size() and jump[i] >= 0 ? jump[i] : deflt);
+   }
+   auto it = lower_bound(sorted.begin(), sorted.end(), make_pair(val, -1));
+   return (it != sorted.end() and it->first == val ? it->second : deflt);
+}
+
 string Literal::escape(string s, char delim) {
    string r;
    for (char c : s) {
@@ -172,6 +176,17 @@ bool IterStmt::has_errors() const {
    return AstNode::has_errors();
 }
 
+bool SwitchStmt::has_errors() const {
+   _ERRORS(cond);
+   for (const Case& c : cases) {
+      _ERRORS(c.label);
+      for (Stmt *s : c.stmts) {
+         _ERRORS(s);
+      }
+   }
+   return AstNode::has_errors();
+}
+
 bool DeclStmt::has_errors() const {
    _ERRORS(typespec);
    for (Item i : items) {
@@ -311,6 +326,9 @@ string TypeSpec::typestr() const {
       i++;
    }
    _id += id->typestr();
+   if (pointer) {
+      _id += "*";
+   }
    if (reference) {
       _id += "&";
    }
@@ -318,7 +336,11 @@ string TypeSpec::typestr() const {
 }
 
 string ArrayDecl::type_str() const {
-   return typespec->typestr() + "[]";
+   string s = typespec->typestr() + "[]";
+   for (int i = 0; i < subsizes.size(); i++) {
+      s += "[]";
+   }
+   return s;
 }
 
 string StructDecl::type_str() const {
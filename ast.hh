@@ -7,10 +7,14 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <memory>
 #include <algorithm>
 #include "input.hh"
+#include "symbol.hh"
 
 class AstVisitor;
+class Type;
+class Value;
 
 struct Error;
 struct CommentSeq;
@@ -82,10 +86,7 @@ struct CommentSeq {
          return;
       }
       int i = items.size()-1;
-      while (true) {
-         if (items[i-1].kind != Comment::endline) {
-            break;
-         }
+      while (i > 0 and items[i-1].kind == Comment::endline) {
          i--;
       }
       items.resize(i+1);
@@ -161,16 +162,53 @@ struct IterStmt : public Stmt { // while + for
    Expr *cond, *post;
    Stmt *substmt;
 
+   // A loop 'for (int i = ...; i < n; i++)' (also '<=', '!=', '--' and 
+   // '+=' or '-=' a constant), recognized by the TypeAnnotator.
+   struct Counted {
+      enum Cmp { Lt, Le, Ne };
+      std::string var;  // induction variable
+      Cmp         cmp;
+      int         step;
+   };
+   std::unique_ptr<Counted> counted; // (replaced on each annotation)
+
    IterStmt() : cond(0), init(0), substmt(0), post(0) {}
    void accept(AstVisitor *v);
    bool is_for() { return init != 0 and post != 0; }
    bool has_errors() const;
 };
 
+struct SwitchStmt : public Stmt {
+   struct Case {
+      Expr *label; // 0 for 'default'
+      std::vector<Stmt*> stmts; // execution falls through to the next case
+      Case() : label(0) {}
+   };
+   Expr *cond;
+   std::vector<Case> cases;
+
+   // Where each value jumps to (the index of a case), built the first
+   // time the switch runs, since labels are constants: a jump table if
+   // the labels are dense, or else a sorted table for a binary search.
+   struct Table {
+      int              min;
+      std::vector<int> jump;   // case of 'min + i' (-1 = none)
+      std::vector<std::pair<int, int>> sorted; // (label, case)
+      int              deflt;  // -1 if there is no 'default'
+
+      int find(int val) const;
+   };
+   Table *table;
+
+   SwitchStmt() : cond(0), table(0) {}
+   void accept(AstVisitor *v);
+   bool has_errors() const;
+};
+
 struct Decl : public AstNode {
    enum Kind { Normal, Pointer };
    TypeSpec *typespec;
-   std::string name;
+   Symbol name;
    Decl() : typespec(0) {}
 };
 
@@ -182,6 +220,7 @@ struct VarDecl : public Decl {
 
 struct ArrayDecl : public Decl {
    Expr *size;
+   std::vector<Expr*> subsizes; // more dimensions: 'a[size][subsizes[0]]...'
    Kind kind;
    ArrayDecl() : size(0), kind(Normal) {}
    void accept(AstVisitor *v);
@@ -238,8 +277,9 @@ struct Expr : public AstNode {
    struct Op2KindInitializer { Op2KindInitializer(); }; // init _op2kind
 
    bool paren; // if this is true, comments will have an extra element!
+   const Type *static_type; // set by the TypeAnnotator (0 = unknown)
 
-   Expr() : paren(false) {}
+   Expr() : paren(false), static_type(0) {}
 
    virtual bool is_read_expr()  const { return false; }
    virtual bool is_write_expr() const { return false; }
@@ -247,9 +287,9 @@ struct Expr : public AstNode {
    virtual void collect_rights(std::list<Expr*>& L) const {}
 
    static std::map<std::string, Kind> _op2kind;
-   static std::map<Token::Kind, Kind> _tok2kind;
+   static Kind _tok2kind[Token::Unknown + 1]; // Unknown = not binary
    static Kind op2kind(std::string op);
-   static Kind tok2kind(Token::Kind toktyp);
+   static Kind tok2kind(Token::Kind toktyp) { return _tok2kind[toktyp]; }
    static Op2KindInitializer initializer;
    static bool right_associative(Kind t);
 
@@ -261,10 +301,37 @@ struct Expr::Error : public Expr {
    void accept(AstVisitor *v);
 };
 
+// Runtime type feedback for self-specializing nodes (filled by the 
+// Interpreter). A node starts 'Uninitialized' and records the operand
+// types it sees; after a few executions with the same types it becomes
+// 'Specialized' to them, and if other types show up later it goes 
+// 'Generic' for good.
+struct TypeFeedback {
+   enum State { Uninitialized, Specialized, Generic };
+   State       state;
+   int         hits;     // executions seen with the same operand types
+   const Type *types[2]; // operand types
+   int         op;       // operator of the specialized evaluator
+
+   TypeFeedback() : state(Uninitialized), hits(0), op(-1) { types[0] = types[1] = 0; }
+
+   bool seen(const Type *t0, const Type *t1 = 0) {
+      if (t0 == types[0] and t1 == types[1]) {
+         return ++hits >= SpecializeAfter;
+      }
+      types[0] = t0, types[1] = t1, hits = 1;
+      return false;
+   }
+   void specialize(int _op) { state = Specialized; op = _op; }
+   void generalize()        { state = Generic; }
+
+   static const int SpecializeAfter = 2;
+};
+
 struct Literal : public Expr {
    enum Type { Bool, Int, String, Char, Float, Double };
    struct StringData {
-      std::string *s;
+      const std::string *s; // interned (see Symbol)
       bool L;
    };
    union Data {
@@ -284,7 +351,7 @@ struct Literal : public Expr {
 };
 
 struct Ident : public Expr {
-   std::string name;
+   Symbol name;
    std::vector<TypeSpec*> subtypes; // for templates
    std::vector<Ident*> prefix;  // for classes & namespaces;
 
@@ -301,8 +368,14 @@ struct BinaryExpr : public Expr {
    std::string op;
    std::string str;
    Expr *left, *right;
+   TypeFeedback feedback;
 
-   BinaryExpr(Kind k = Unknown) : kind(k), op("") {}
+   // Assignments to strings done in place (marked by the TypeAnnotator):
+   // 's = s + x' as 's += x', and 's[i] = c'
+   enum InPlace { NotInPlace, Append, StoreChar };
+   InPlace inplace;
+
+   BinaryExpr(Kind k = Unknown) : kind(k), op(""), inplace(NotInPlace) {}
 
    void accept(AstVisitor *v);
    void set(Expr::Kind _kind);
@@ -332,6 +405,7 @@ struct IncrExpr : public UnaryExpr {
    enum Kind { Positive, Negative };
    Kind kind;
    bool preincr;
+   TypeFeedback feedback;
    IncrExpr(Kind k, bool pre = false) : kind(k), preincr(pre) {}
    void accept(AstVisitor *v);
    std::string describe() const;
@@ -349,6 +423,20 @@ struct DerefExpr : public UnaryExpr {
    void accept(AstVisitor *v);
 };
 
+struct NewExpr : public Expr {
+   TypeSpec *typespec;
+   Expr *size; // 'new T[size]'
+   Expr *init; // 'new T(init)' or 'new T{...}' (an ExprList)
+   NewExpr() : typespec(0), size(0), init(0) {}
+   void accept(AstVisitor *v);
+};
+
+struct DeleteExpr : public UnaryExpr {
+   bool array; // 'delete[] p'
+   DeleteExpr() : array(false) {}
+   void accept(AstVisitor *v);
+};
+
 struct CallExpr : public Expr {
    Expr *func;
    std::vector<Expr *> args;
@@ -359,7 +447,15 @@ struct CallExpr : public Expr {
 
 struct IndexExpr : public Expr {
    Expr *base, *index;
-   IndexExpr() : base(0), index(0) {}
+   TypeFeedback feedback;
+
+   // For 'a[i][j]...' on a variable, the number of indices (set by the
+   // TypeAnnotator), so that the Interpreter can apply them all at once
+   // (0 otherwise)
+   int chain;
+   static const int MaxChain = 8;
+
+   IndexExpr() : base(0), index(0), chain(0) {}
    void accept(AstVisitor *v);
    bool has_errors() const;
 };
@@ -369,6 +465,16 @@ struct FieldExpr : public Expr {
    Ident *field;
    bool pointer;
 
+   // Monomorphic inline cache, filled by the Interpreter: the method
+   // resolved for the last receiver type (and the type of the method).
+   struct MethodCache {
+      const Type *type;
+            Type *functype;
+           Value (*method)(void *, const std::vector<Value>&);
+      MethodCache() : type(0), functype(0), method(0) {}
+   };
+   MethodCache cache;
+
    FieldExpr() : base(0), field(0) {}
    void accept(AstVisitor *v);
    bool has_errors() const;
@@ -396,10 +502,11 @@ struct TypeSpec : public AstNode {
    };
 
    bool                    reference;
+   bool                    pointer; // (only for parameters and return types)
    std::vector<Qualifiers> qual;
    Ident                  *id;
 
-   TypeSpec() : id(0), reference(false) {}
+   TypeSpec() : id(0), reference(false), pointer(false) {}
    void accept(AstVisitor *v);
    bool has_errors() const;
    bool is_const() const;
@@ -413,7 +520,7 @@ struct TypeSpec : public AstNode {
 
 struct ParamDecl : public AstNode {
   TypeSpec *typespec;
-  std::string name;
+  Symbol name;
   ParamDecl() : typespec(0) {}
 
   void accept(AstVisitor *v);
@@ -531,6 +638,7 @@ public:
    virtual void visit_exprstmt(ExprStmt *)        { assert(false); }
    virtual void visit_ifstmt(IfStmt *)            { assert(false); }
    virtual void visit_iterstmt(IterStmt *)        { assert(false); }
+   virtual void visit_switchstmt(SwitchStmt *)    { assert(false); }
    virtual void visit_jumpstmt(JumpStmt *)        { assert(false); }
    virtual void visit_callexpr(CallExpr *)        { assert(false); }
    virtual void visit_indexexpr(IndexExpr *)      { assert(false); }
@@ -542,6 +650,8 @@ public:
    virtual void visit_negexpr(NegExpr *)          { assert(false); }
    virtual void visit_addrexpr(AddrExpr *)        { assert(false); }
    virtual void visit_derefexpr(DerefExpr *)      { assert(false); }
+   virtual void visit_newexpr(NewExpr *)          { assert(false); }
+   virtual void visit_deleteexpr(DeleteExpr *)    { assert(false); }
    virtual void visit_literal(Literal *)          { assert(false); }
    virtual void visit_paramdecl(ParamDecl *)              { assert(false); }
 
@@ -569,6 +679,7 @@ inline void DeclStmt::accept(AstVisitor *v)      { v->visit_declstmt(this); }
 inline void ExprStmt::accept(AstVisitor *v)      { v->visit_exprstmt(this); }
 inline void IfStmt::accept(AstVisitor *v)        { v->visit_ifstmt(this); }
 inline void IterStmt::accept(AstVisitor *v)      { v->visit_iterstmt(this); }
+inline void SwitchStmt::accept(AstVisitor *v)    { v->visit_switchstmt(this); }
 inline void JumpStmt::accept(AstVisitor *v)      { v->visit_jumpstmt(this); }
 inline void CallExpr::accept(AstVisitor *v)      { v->visit_callexpr(this); }
 inline void IndexExpr::accept(AstVisitor *v)     { v->visit_indexexpr(this); }
@@ -580,6 +691,8 @@ inline void IncrExpr::accept(AstVisitor *v)      { v->visit_increxpr(this); }
 inline void NegExpr::accept(AstVisitor *v)       { v->visit_negexpr(this); }
 inline void AddrExpr::accept(AstVisitor *v)      { v->visit_addrexpr(this); }
 inline void DerefExpr::accept(AstVisitor *v)     { v->visit_derefexpr(this); }
+inline void NewExpr::accept(AstVisitor *v)       { v->visit_newexpr(this); }
+inline void DeleteExpr::accept(AstVisitor *v)    { v->visit_deleteexpr(this); }
 inline void Literal::accept(AstVisitor *v)       { v->visit_literal(this); }
 inline void ParamDecl::accept(AstVisitor *v)     { v->visit_paramdecl(this); }
 
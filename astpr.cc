@@ -30,7 +30,7 @@ void AstPrinter::visit_using(Using* x) {
 }
 
 void AstPrinter::visit_typespec(TypeSpec *x) {
-   out() << "Type" << (x->reference ? "<&>" : "") << "(";
+   out() << "Type" << (x->pointer ? "<*>" : "") << (x->reference ? "<&>" : "") << "(";
    x->id->accept(this);
    if (!x->qual.empty()) {
       out() << ", {";
@@ -225,6 +225,10 @@ void AstPrinter::visit_vardecl(VarDecl *x) {
 void AstPrinter::visit_arraydecl(ArrayDecl *x) {
    out() << '"' << x->name << "\"(Size = ";
    x->size->accept(this);
+   for (Expr *size : x->subsizes) {
+      out() << ", ";
+      size->accept(this);
+   }
    /*
    if (x->init) {
       out() << ", Init = ";
@@ -321,6 +325,31 @@ void AstPrinter::visit_iterstmt(IterStmt *x) {
    out(beginl) << "})";
 }
 
+void AstPrinter::visit_switchstmt(SwitchStmt *x) {
+   out() << "SwitchStmt(";
+   x->cond->accept(this);
+   out() << ", {" << endl;
+   indent(+1);
+   for (SwitchStmt::Case& c : x->cases) {
+      if (c.label) {
+         out(beginl) << "Case(";
+         c.label->accept(this);
+         out() << "):" << endl;
+      } else {
+         out(beginl) << "Default:" << endl;
+      }
+      indent(+1);
+      for (Stmt *s : c.stmts) {
+         out(beginl);
+         s->accept(this);
+         out() << endl;
+      }
+      indent(-1);
+   }
+   indent(-1);
+   out(beginl) << "})";
+}
+
 void AstPrinter::visit_jumpstmt(JumpStmt *x) {
    string keyword[3] = { "break", "continue", "goto" };
    out() << "JumpStmt<" << keyword[x->kind] << ">(";
@@ -414,6 +443,26 @@ void AstPrinter::visit_derefexpr(DerefExpr *x) {
    out() << ")";
 }
 
+void AstPrinter::visit_newexpr(NewExpr *x) {
+   out() << "NewExpr(";
+   x->typespec->accept(this);
+   if (x->size) {
+      out() << ", Size = ";
+      x->size->accept(this);
+   }
+   if (x->init) {
+      out() << ", Init = ";
+      x->init->accept(this);
+   }
+   out() << ")";
+}
+
+void AstPrinter::visit_deleteexpr(DeleteExpr *x) {
+   out() << "DeleteExpr" << (x->array ? "[]" : "") << "(";
+   x->expr->accept(this);
+   out() << ")";
+}
+
 void AstPrinter::visit_errorstmt(Stmt::Error *x) {
    out() << "ErrorStmt(\"" << x->code << "\")";
 }
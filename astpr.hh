@@ -35,6 +35,7 @@ public:
    void visit_exprstmt(ExprStmt *x);
    void visit_ifstmt(IfStmt *x);
    void visit_iterstmt(IterStmt *x);
+   void visit_switchstmt(SwitchStmt *x);
    void visit_jumpstmt(JumpStmt *x);
    void visit_callexpr(CallExpr *x);
    void visit_indexexpr(IndexExpr *x);
@@ -46,6 +47,8 @@ public:
    void visit_negexpr(NegExpr *x);
    void visit_addrexpr(AddrExpr *x);
    void visit_derefexpr(DerefExpr *x);
+   void visit_newexpr(NewExpr *x);
+   void visit_deleteexpr(DeleteExpr *x);
 
    void visit_errorstmt(Stmt::Error *x);
    void visit_errorexpr(Expr::Error *x);
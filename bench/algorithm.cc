@@ -0,0 +1,23 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+using namespace std;
+
+// Same work as algorithm_loops.cc, with the library
+
+int main() {
+   int n = 1000;
+   vector<int> v(1000);
+   for (int i = 0; i < n; i++) {
+      v[i] = (i * 7919) % 1009;
+   }
+   int total = 0;
+   for (int k = 0; k < 20; k++) {
+      total += accumulate(v.begin(), v.end(), 0);
+      total += count(v.begin(), v.end(), k);
+      total += *max_element(v.begin(), v.end()) - *min_element(v.begin(), v.end());
+   }
+   sort(v.begin(), v.end());
+   cout << total << ' ' << v[0] << ' ' << v[n / 2] << ' ' << v[n - 1] << endl;
+}
@@ -0,0 +1,40 @@
+#include <iostream>
+#include <vector>
+using namespace std;
+
+// Same work as algorithm.cc, with hand-written loops
+
+int main() {
+   int n = 1000;
+   vector<int> v(1000);
+   for (int i = 0; i < n; i++) {
+      v[i] = (i * 7919) % 1009;
+   }
+   int total = 0;
+   for (int k = 0; k < 20; k++) {
+      int sum = 0, cnt = 0, lo = v[0], hi = v[0];
+      for (int i = 0; i < n; i++) {
+         sum += v[i];
+         if (v[i] == k) {
+            cnt++;
+         }
+         if (v[i] < lo) {
+            lo = v[i];
+         }
+         if (v[i] > hi) {
+            hi = v[i];
+         }
+      }
+      total += sum + cnt + hi - lo;
+   }
+   for (int i = 1; i < n; i++) {
+      int x = v[i];
+      int j = i - 1;
+      while (j >= 0 && v[j] > x) {
+         v[j + 1] = v[j];
+         j--;
+      }
+      v[j + 1] = x;
+   }
+   cout << total << ' ' << v[0] << ' ' << v[n / 2] << ' ' << v[n - 1] << endl;
+}
@@ -0,0 +1,16 @@
+#!/bin/bash
+#
+# Times the interpreter on every program in this directory.
+#
+#   ./bench.sh [minicc-binary] [extra minicc flags...]
+#
+
+minicc=${1:-../minicc}
+shift
+
+TIMEFORMAT=%R
+for ccfile in $(ls *.cc | sort); do
+   secs=$( { time $minicc "$@" $ccfile > /tmp/bench-$$.out 2>&1 < /dev/null; } 2>&1 )
+   printf "%-16s %7ss   %s\n" $ccfile $secs "$(head -c 40 /tmp/bench-$$.out | tr '\n' ' ')"
+done
+rm -f /tmp/bench-$$.out
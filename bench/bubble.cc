@@ -0,0 +1,20 @@
+#include <iostream>
+using namespace std;
+
+int main() {
+   int n = 300;
+   vector<int> v(300);
+   for (int i = 0; i < n; i++) {
+      v[i] = (i * 7919) % n;
+   }
+   for (int i = 0; i < v.size(); i++) {
+      for (int j = 0; j + 1 < v.size() - i; j++) {
+         if (v[j] > v[j + 1]) {
+            int tmp = v[j];
+            v[j] = v[j + 1];
+            v[j + 1] = tmp;
+         }
+      }
+   }
+   cout << v[0] << ' ' << v[n / 2] << ' ' << v[n - 1] << endl;
+}
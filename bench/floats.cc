@@ -0,0 +1,12 @@
+#include <iostream>
+using namespace std;
+
+int main() {
+   double x = 0.0, step = 0.001;
+   int i = 0;
+   while (i < 200000) {
+      x = x + step * 2.0 - step;
+      i++;
+   }
+   cout << x << endl;
+}
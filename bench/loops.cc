@@ -0,0 +1,15 @@
+#include <iostream>
+using namespace std;
+
+int main() {
+   int n = 400;
+   int total = 0;
+   for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+         if ((i * j) % 7 < 3) {
+            total = total + i + j;
+         }
+      }
+   }
+   cout << total << endl;
+}
@@ -0,0 +1,39 @@
+#!/bin/bash
+#
+# Times the parser on generated programs of growing size, which should
+# grow linearly with the number of lines.
+#
+#   ./parse.sh [minicc-binary] [sizes...]
+#
+
+minicc=${1:-../minicc}
+shift
+sizes=${@:-1000 10000 100000}
+
+# A program with 'nlines' lines of small functions
+function program() {
+   awk -v nlines=$1 'BEGIN {
+      print "#include <iostream>"
+      print "using namespace std;"
+      for (i = 0; 8 * (i + 1) + 3 <= nlines; i++) {
+         printf "int f%d(int a, int b) {\n", i
+         printf "   int x = a * %d + b; // comment\n", i
+         printf "   if (x > %d) {\n", i
+         print  "      x = x - 1;"
+         print  "   }"
+         print  "   return x;"
+         print  "}"
+         print  ""
+      }
+      print "int main() {}"
+   }'
+}
+
+TIMEFORMAT=%R
+for n in $sizes; do
+   program $n > /tmp/parse-$$.cc
+   lines=$(wc -l < /tmp/parse-$$.cc)
+   secs=$( { time $minicc --ast /tmp/parse-$$.cc > /dev/null; } 2>&1 )
+   awk -v n=$lines -v s=$secs 'BEGIN { printf "%8d lines %8.3fs %8.3fs/10k lines\n", n, s, s * 10000 / n }'
+done
+rm -f /tmp/parse-$$.cc
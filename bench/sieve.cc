@@ -0,0 +1,17 @@
+#include <iostream>
+using namespace std;
+
+int main() {
+   int n = 100000;
+   vector<bool> composite(100001, false);
+   int count = 0;
+   for (int i = 2; i <= n; i++) {
+      if (composite[i] == false) {
+         count++;
+         for (int j = i + i; j <= n; j += i) {
+            composite[j] = true;
+         }
+      }
+   }
+   cout << count << endl;
+}
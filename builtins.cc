@@ -0,0 +1,117 @@
+#include <cmath>
+#include <algorithm>
+#include "translator.hh"
+#include "builtins.hh"
+using namespace std;
+
+// <cmath> and <cstdlib>
+
+static double _sqrt(double x)           { return std::sqrt(x); }
+static double _pow(double x, double y)  { return std::pow(x, y); }
+static double _fabs(double x)           { return std::fabs(x); }
+static double _floor(double x)          { return std::floor(x); }
+static double _ceil(double x)           { return std::ceil(x); }
+static double _exp(double x)            { return std::exp(x); }
+static double _log(double x)            { return std::log(x); }
+static double _sin(double x)            { return std::sin(x); }
+static double _cos(double x)            { return std::cos(x); }
+
+// abs is also 'double abs(double)' (as in <cmath>), so it takes the 
+// type of its argument instead of a single signature
+
+static Value _abs(const vector<Value>& args) {
+   if (args.size() != 1) {
+      throw new EvalError(_T("Error en el número de argumentos al llamar a '%s'", "abs"));
+   }
+   Value x = Reference::deref(args[0]);
+   if (x.data() != 0) {
+      if (x.is<Int>())    { return Value(std::abs(x.as<Int>())); }
+      if (x.is<Double>()) { return Value(std::fabs(x.as<Double>())); }
+      if (x.is<Float>())  { return Value(std::fabs(x.as<Float>())); }
+      if (x.is<Char>())   { return Value(std::abs(int(x.as<Char>()))); }
+   }
+   string t = (x.is_null() ? "?" : x.type_name());
+   throw new EvalError(_T("El argumento %d no es compatible con el tipo del parámetro "
+                          "(%s vs %s)", 1, "int", t.c_str()));
+}
+
+// max and min take two values of the same type (as std::max and std::min)
+// and give one of them, keeping that type
+
+static Value _max_or_min(const char *name, const vector<Value>& args, bool is_max) {
+   if (args.size() != 2) {
+      throw new EvalError(_T("Error en el número de argumentos al llamar a '%s'", name));
+   }
+   Value a = Reference::deref(args[0]), b = Reference::deref(args[1]);
+   const bool comparable = 
+      a.is<Int>() or a.is<Double>() or a.is<Float>() or 
+      a.is<Char>() or a.is<Bool>() or a.is<String>();
+   if (!comparable or a.data() == 0 or b.data() == 0 or !a.same_type_as(b)) {
+      string t1 = (a.is_null() ? "?" : a.type_name());
+      string t2 = (b.is_null() ? "?" : b.type_name());
+      throw new EvalError(_T("Los argumentos de '%s' deben ser del mismo tipo (%s vs %s)",
+                             name, t1.c_str(), t2.c_str()));
+   }
+   if (is_max) {
+      return (a.less(b) ? b : a).clone();
+   } else {
+      return (b.less(a) ? b : a).clone();
+   }
+}
+
+static Value _max(const vector<Value>& args) { return _max_or_min("max", args, true); }
+static Value _min(const vector<Value>& args) { return _max_or_min("min", args, false); }
+
+// rand() is the generator given as an example in the C standard, so that
+// every program gives the same sequence on every platform.
+
+static const int RAND_MAX_ = 32767;
+static unsigned int _rand_next = 1;
+
+static int _rand() {
+   _rand_next = _rand_next * 1103515245 + 12345;
+   return (_rand_next / 65536) % (RAND_MAX_ + 1);
+}
+
+static void _srand(int seed) {
+   _rand_next = seed;
+}
+
+// <utility>
+
+static Value _make_pair(const vector<Value>& args) {
+   if (args.size() != 2) {
+      throw new EvalError(_T("Error en el número de argumentos al llamar a '%s'", "make_pair"));
+   }
+   Value first = Reference::deref(args[0]), second = Reference::deref(args[1]);
+   SimpleTable<Value> *fields = new SimpleTable<Value>();
+   fields->set("first", first.clone());
+   fields->set("second", second.clone());
+   return Value(Pair::mkpair(first.type(), second.type()), fields);
+}
+
+void Interpreter::prepare_builtins() {
+   bind("sqrt",  _sqrt);
+   bind("pow",   _pow);
+   bind("fabs",  _fabs);
+   bind("floor", _floor);
+   bind("ceil",  _ceil);
+   bind("exp",   _exp);
+   bind("log",   _log);
+   bind("sin",   _sin);
+   bind("cos",   _cos);
+   bind("rand",  _rand);
+   bind("srand", _srand);
+   setenv("RAND_MAX", Value(RAND_MAX_), true);
+   setenv("npos",     Value(-1), true); // string::npos
+   setenv("nullptr",  Pointer::null->create(), true);
+   setenv("NULL",     Pointer::null->create(), true);
+   Function *make_pair_type = new Function(0, true);
+   setenv("make_pair", make_pair_type->mkvalue("make_pair", new BuiltinFunc(_make_pair)), true);
+   Function *abs_type = new Function(0, true);
+   setenv("abs", abs_type->mkvalue("abs", new BuiltinFunc(_abs)), true);
+   Function *max_type = new Function(0, true), *min_type = new Function(0, true);
+   setenv("max", max_type->mkvalue("max", new BuiltinFunc(_max)), true);
+   setenv("min", min_type->mkvalue("min", new BuiltinFunc(_min)), true);
+   _rand_next = 1;
+}
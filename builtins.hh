@@ -0,0 +1,120 @@
+#ifndef BUILTINS_HH
+#define BUILTINS_HH
+
+#include <string>
+#include <vector>
+#include "translator.hh"
+#include "interpreter.hh"
+
+// Binding of native C++ functions as builtins:
+//
+//    bind("sqrt", _sqrt);   // with double _sqrt(double)
+//
+// derives the Function type from the signature, converts each argument
+// straight from the Value (as C++ would for numbers) and boxes the result.
+
+template<typename T> struct TypeOf {};  // the Type for a C++ type
+template<> struct TypeOf<int>         { typedef Int    type; };
+template<> struct TypeOf<float>       { typedef Float  type; };
+template<> struct TypeOf<double>      { typedef Double type; };
+template<> struct TypeOf<char>        { typedef Char   type; };
+template<> struct TypeOf<bool>        { typedef Bool   type; };
+template<> struct TypeOf<std::string> { typedef String type; };
+
+template<typename T>
+struct NativeArg {
+   static bool get(const Value& v, T& x) {
+      if (v.type() == TypeOf<T>::type::self) {
+         x = TypeOf<T>::type::cast(v.data());
+      }
+      else if (v.is<Int>())    { x = T(v.as<Int>()); }
+      else if (v.is<Double>()) { x = T(v.as<Double>()); }
+      else if (v.is<Float>())  { x = T(v.as<Float>()); }
+      else if (v.is<Char>())   { x = T(v.as<Char>()); }
+      else if (v.is<Bool>())   { x = T(v.as<Bool>()); }
+      else {
+         return false;
+      }
+      return true;
+   }
+};
+
+template<>
+struct NativeArg<std::string> {
+   static bool get(const Value& v, std::string& x) {
+      if (!v.is<String>()) {
+         return false;
+      }
+      x = v.as<String>();
+      return true;
+   }
+};
+
+template<int...> struct Indices {};
+template<int N, int... K> struct MakeIndices : MakeIndices<N-1, N-1, K...> {};
+template<int... K> struct MakeIndices<0, K...> { typedef Indices<K...> type; };
+
+template<typename R>
+struct NativeResult {
+   static Type *type() { return TypeOf<R>::type::self; }
+   template<typename... Args, typename... Params>
+   static Value call(R (*fn)(Params...), Args... args) { return Value(fn(args...)); }
+};
+
+template<>
+struct NativeResult<void> {
+   static Type *type() { return 0; }
+   template<typename... Args, typename... Params>
+   static Value call(void (*fn)(Params...), Args... args) { fn(args...); return Value::null; }
+};
+
+template<typename R, typename... Params>
+struct NativeFunc : public FuncPtr {
+   typedef R (*Ptr)(Params...);
+   std::string name;
+   Ptr         fn;
+
+   NativeFunc(std::string n, Ptr f) : name(n), fn(f) {}
+
+   static Function *type() {
+      Function *f = new Function(NativeResult<R>::type(), true);
+      std::vector<Type*> params = { TypeOf<Params>::type::self... };
+      for (Type *t : params) {
+         f->add_param(t);
+      }
+      return f;
+   }
+
+   template<typename T>
+   T arg(Interpreter *I, const std::vector<Value>& args, int i) {
+      Value v = Reference::deref(args[i]);
+      T x;
+      if (v.data() == 0 or !NativeArg<T>::get(v, x)) {
+         std::string t1 = TypeOf<T>::type::self->typestr();
+         std::string t2 = (v.is_null() ? "?" : v.type_name());
+         I->_error(_T("El argumento %d no es compatible con el tipo del parámetro "
+                      "(%s vs %s)", i+1, t1.c_str(), t2.c_str()));
+      }
+      return x;
+   }
+
+   template<int... K>
+   Value call(Interpreter *I, const std::vector<Value>& args, Indices<K...>) {
+      return NativeResult<R>::call(fn, arg<Params>(I, args, K)...);
+   }
+
+   void invoke(Interpreter *I, const std::vector<Value>& args) {
+      if (args.size() != sizeof...(Params)) {
+         I->_error(_T("Error en el número de argumentos al llamar a '%s'", name.c_str()));
+      }
+      I->_ret = call(I, args, typename MakeIndices<sizeof...(Params)>::type());
+   }
+};
+
+template<typename R, typename... Params>
+void Interpreter::bind(std::string name, R (*fn)(Params...)) {
+   typedef NativeFunc<R, Params...> Native;
+   setenv(name, Native::type()->mkvalue(name, new Native(name, fn)), true);
+}
+
+#endif
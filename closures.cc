@@ -0,0 +1,1082 @@
+#include <algorithm>
+#include "translator.hh"
+#include "closures.hh"
+using namespace std;
+
+// Both operands are initialized values of type T
+template<class T>
+inline bool both(const Value& a, const Value& b) {
+   return a.type() == T::self and b.type() == T::self and
+      a.data() != 0 and b.data() != 0;
+}
+
+// Expressions which the Interpreter always evaluates to a Reference
+inline bool is_place(Expr *x) {
+   return x->is<Ident>() or x->is<IndexExpr>();
+}
+
+// Expressions which the Interpreter never evaluates to a Reference
+bool is_plain(Expr *x) {
+   if (x->is<Literal>() or x->is<IncrExpr>() or
+       x->is<ExprList>() or x->is<NegExpr>()) {
+      return true;
+   }
+   if (x->is<SignExpr>()) {
+      return dynamic_cast<SignExpr*>(x)->kind == SignExpr::Negative;
+   }
+   if (x->is<BinaryExpr>()) {
+      BinaryExpr *bx = dynamic_cast<BinaryExpr*>(x);
+      if (bx->kind == Expr::Assignment) {
+         return bx->op == "=";
+      }
+      return bx->op != "<<" and bx->op != ">>";
+   }
+   return false;
+}
+
+// Comparisons (and logical operations of comparisons) always give a 'bool'
+bool is_boolean(Expr *x) {
+   BinaryExpr *bx = dynamic_cast<BinaryExpr*>(x);
+   if (bx == 0) {
+      return false;
+   }
+   const string& op = bx->op;
+   if (op == "&&" or op == "and" or op == "||" or op == "or") {
+      return is_boolean(bx->left) and is_boolean(bx->right);
+   }
+   return op == "<" or op == "<=" or op == ">" or op == ">=" or
+      op == "==" or op == "!=";
+}
+
+Value literal_value(Literal *x) {
+   switch (x->type) {
+   case Literal::String: return Value(*x->val.as_string.s);
+   case Literal::Int:    return Value(x->val.as_int);
+   case Literal::Double: return Value(x->val.as_double);
+   case Literal::Bool:   return Value(x->val.as_bool);
+   case Literal::Char:   return Value((*x->val.as_string.s)[0] /* FIXME */);
+   default:
+      return Value::null;
+   }
+}
+
+// Functions ////////////////////////////////////////////////////////
+
+void ClosureCompiler::visit_program(Program *x) {
+   I.visit_program_prepare(x);
+   I.visit_program_find_main();
+   UserFunc *main = dynamic_cast<UserFunc*>(I._curr.as<Function>().ptr);
+   assert(main != 0);
+   invoke(main->decl, vector<Value>());
+}
+
+ClosureCompiler::Func *ClosureCompiler::function(FuncDecl *x) {
+   auto it = _funcs.find(x);
+   if (it != _funcs.end()) {
+      return it->second;
+   }
+   assert(_scopes.empty());
+   Func *f = new Func();
+   _funcs[x] = f;
+   _scopes.push_back(Scope());
+   _refslots.clear();
+   for (ParamDecl *p : x->params) {
+      const int k = slot(p->name);
+      f->params.push_back(k);
+      if (p->typespec->reference) {
+         _refslots[k] = true;
+      }
+   }
+   declare(x->block);
+   f->body = action(x->block);
+   f->nslots = _refslots.size();
+   _scopes.pop_back();
+   for (auto& e : _declared) {
+      sort(e.second.rbegin(), e.second.rend()); // inner scopes have later slots
+      f->names.push_back(make_pair(&_active[e.first], e.second));
+   }
+   _declared.clear();
+   return f;
+}
+
+void ClosureCompiler::invoke(FuncDecl *x, const vector<Value>& args) {
+   Func *f = function(x);
+   if (x->params.size() != args.size()) {
+      _error(_T("Error en el número de argumentos al llamar a '%s'",
+                x->funcname().c_str()));
+   }
+   vector<Value> frame(f->nslots + 1);
+   for (int i = 0; i < args.size(); i++) {
+      Value v = args[i];
+      if (v.is<Reference>()) {
+         if (!x->params[i]->typespec->reference) {
+            v = Reference::deref(v).clone();
+         }
+      } else if (x->params[i]->typespec->reference) {
+         _error(_T("En el parámetro %d se requiere una variable.", i+1));
+      }
+      frame[f->params[i]] = v;
+   }
+   Value *caller = _frame;
+   _frame = &frame[0];
+   for (auto& n : f->names) {
+      n.first->push_back(Active{_frame, &n.second});
+   }
+   f->body();
+   I._break = false;
+   for (auto& n : f->names) {
+      n.first->pop_back();
+   }
+   _frame = caller;
+}
+
+Value ClosureCompiler::call(Value func, const vector<Code>& args) {
+   const Function *func_type = func.type()->as<Function>();
+   vector<Value> vals;
+   for (const Code& arg : args) {
+      vals.push_back(arg());
+   }
+   I.visit_callexpr_check(func_type, vals);
+   FuncValue& fv = func.as<Function>();
+   UserFunc *user = dynamic_cast<UserFunc*>(fv.ptr);
+   if (user != 0) {
+      invoke(user->decl, vals);
+   } else {
+      fv.invoke(&I, vals);
+   }
+   if (I._ret == Value::null && !func_type->is_void()) {
+      _error(_T("La función '%s' debería devolver un '%s'",
+                fv.name.c_str(), func_type->return_type()->typestr().c_str()));
+   }
+   return I._ret;
+}
+
+// Names ////////////////////////////////////////////////////////////
+
+int ClosureCompiler::slot(string name) {
+   Scope& scope = _scopes.back();
+   auto it = scope.find(name);
+   if (it != scope.end()) {
+      return it->second;
+   }
+   const int k = _refslots.size();
+   scope[name] = k;
+   _declared[name].push_back(k);
+   _refslots.push_back(false);
+   return k;
+}
+
+// Give a slot to every name declared in the current scope (the
+// Interpreter only pushes an environment for functions and loops).
+void ClosureCompiler::declare(Stmt *x) {
+   if (x == 0) {
+      return;
+   }
+   if (x->is<Block>()) {
+      for (Stmt *stmt : dynamic_cast<Block*>(x)->stmts) {
+         declare(stmt);
+      }
+   } else if (x->is<IfStmt>()) {
+      declare(dynamic_cast<IfStmt*>(x)->then);
+      declare(dynamic_cast<IfStmt*>(x)->els);
+   } else if (x->is<DeclStmt>()) {
+      for (DeclStmt::Item& item : dynamic_cast<DeclStmt*>(x)->items) {
+         slot(item.decl->name);
+      }
+   }
+}
+
+ClosureCompiler::Binding ClosureCompiler::bind(string name) {
+   Binding b;
+   b.name = name;
+   b.callers = &_active[name];
+   for (int i = _scopes.size()-1; i >= 0; i--) {
+      auto it = _scopes[i].find(name);
+      if (it != _scopes[i].end()) {
+         b.slots.push_back(it->second);
+      }
+   }
+   if (I._env[0].get(name, b.global) and !b.global.is_null()) {
+      b.globalref = (b.global.is<Reference>() ? b.global : Reference::mkref(b.global));
+   }
+   return b;
+}
+
+bool ClosureCompiler::find(const Binding& b, bool ref, Value& v) {
+   for (int k : b.slots) {
+      Value& s = _frame[k];
+      if (!s.is_null()) {
+         if (ref) {
+            v = (s.is<Reference>() ? s : Reference::mkref(s));
+         } else {
+            v = Reference::deref(s);
+         }
+         return true;
+      }
+   }
+   for (int i = int(b.callers->size())-1; i >= 0; i--) {
+      const Active& a = (*b.callers)[i];
+      for (int k : *a.slots) {
+         Value& s = a.frame[k];
+         if (!s.is_null()) {
+            if (ref) {
+               v = (s.is<Reference>() ? s : Reference::mkref(s));
+            } else {
+               v = Reference::deref(s);
+            }
+            return true;
+         }
+      }
+   }
+   if (b.global.is_null()) {
+      return false;
+   }
+   v = (ref ? b.globalref : b.global);
+   return true;
+}
+
+Value ClosureCompiler::lookup(const Binding& b, bool ref) {
+   Value v;
+   if (!find(b, ref, v)) {
+      _error(_T("La variable '%s' no existe.", b.name.c_str()));
+   }
+   return v;
+}
+
+ClosureCompiler::Code ClosureCompiler::ident(Ident *x, bool ref) {
+   Binding b = bind(x->name);
+   if (b.slots.empty() and !b.global.is_null()) {
+      Value g = (ref ? b.globalref : b.global);
+      Callers *callers = b.callers;
+      return [this, g, callers, b, ref]() { 
+         return (callers->empty() ? g : lookup(b, ref)); 
+      };
+   }
+   if (!ref and b.slots.size() == 1 and !_refslots[b.slots[0]]) {
+      const int k = b.slots[0];
+      return [this, k, b]() -> Value {
+         const Value& v = _frame[k];
+         return (v.is_null() ? lookup(b, false) : v);
+      };
+   }
+   return [this, b, ref]() { return lookup(b, ref); };
+}
+
+// Compilation entry points /////////////////////////////////////////
+
+ClosureCompiler::Code ClosureCompiler::code(Expr *x) {
+   x->accept(this);
+   return _code;
+}
+
+ClosureCompiler::Code ClosureCompiler::value(Expr *x) {
+   if (x->is<Ident>()) {
+      return ident(dynamic_cast<Ident*>(x), false);
+   }
+   if (x->is<IndexExpr>()) {
+      return indexexpr(dynamic_cast<IndexExpr*>(x), false);
+   }
+   Code c = code(x);
+   if (is_plain(x)) {
+      return c;
+   }
+   return [c]() { return Reference::deref(c()); };
+}
+
+ClosureCompiler::Code ClosureCompiler::operand(Expr *x) {
+   if (x->is<Literal>()) {
+      Value v = literal_value(dynamic_cast<Literal*>(x));
+      if (!v.is_null()) {
+         return [v]() { return v; };
+      }
+   }
+   return value(x);
+}
+
+ClosureCompiler::Test ClosureCompiler::test(Expr *x, std::function<void ()> fail) {
+   if (is_boolean(x)) {
+      return binaryexpr_test(dynamic_cast<BinaryExpr*>(x));
+   }
+   Code c = code(x);
+   return [c, fail]() -> bool {
+      Value v = c();
+      if (!v.is<Bool>()) {
+         fail();
+      }
+      return Bool::cast(v.data());
+   };
+}
+
+ClosureCompiler::Action ClosureCompiler::action(Stmt *x) {
+   x->accept(this);
+   return _action;
+}
+
+ClosureCompiler::Action ClosureCompiler::effect(Expr *x) {
+   Code c;
+   BinaryExpr *bx = dynamic_cast<BinaryExpr*>(x);
+   if (bx != 0 and bx->kind == Expr::Assignment) {
+      c = binaryexpr_assignment(bx, true);
+   } else if (x->is<IncrExpr>()) {
+      c = increxpr(dynamic_cast<IncrExpr*>(x), true);
+   } else {
+      c = code(x);
+   }
+   return [c]() { c(); };
+}
+
+// Statements ///////////////////////////////////////////////////////
+
+void ClosureCompiler::visit_block(Block *x) {
+   const int breaks = _breaks;
+   vector<Action> stmts;
+   for (Stmt *stmt : x->stmts) {
+      stmts.push_back(action(stmt));
+   }
+   if (_breaks == breaks) {
+      _action = [stmts]() {
+         for (const Action& stmt : stmts) {
+            stmt();
+         }
+      };
+      return;
+   }
+   _action = [this, stmts]() {
+      for (const Action& stmt : stmts) {
+         stmt();
+         if (I._break) {
+            return;
+         }
+      }
+   };
+}
+
+void ClosureCompiler::visit_declstmt(DeclStmt *x) {
+   vector<Action> items;
+   for (DeclStmt::Item& item : x->items) {
+      const int k = slot(item.decl->name);
+      if (item.decl->is<VarDecl>()) {
+         VarDecl *d = dynamic_cast<VarDecl*>(item.decl);
+         Code init = (item.init ? value(item.init) : Code());
+         Type *type = Type::get(d->typespec);
+         if (type != 0 and d->kind == Decl::Pointer) {
+            type = Pointer::mkpointer(type);
+         }
+         items.push_back([this, d, k, init, type]() {
+            Value v = (init ? init() : Value());
+            if (type == 0) {
+               _error(_T("El tipo '%s' no existe.", d->typespec->typestr().c_str()));
+            }
+            try {
+               _frame[k] = (v.is_null() ? type->create() : type->convert(v));
+            } catch (TypeError& e) {
+               _error(e.msg);
+            }
+            if (_frame[k].is_null() and !v.is_null()) {
+               _error(_T("La inicialización no se puede hacer porque los tipos no son compatibles"));
+            }
+         });
+      } else if (item.decl->is<ArrayDecl>()) {
+         ArrayDecl *d = dynamic_cast<ArrayDecl*>(item.decl);
+         Code init = (item.init ? code(item.init) : Code());
+         vector<Code> sizes(1, value(d->size));
+         for (Expr *size : d->subsizes) {
+            sizes.push_back(value(size));
+         }
+         Type *celltype = Type::get(d->typespec);
+         items.push_back([this, d, k, init, sizes, celltype]() {
+            Value v = (init ? init() : Value());
+            vector<int> dims;
+            for (const Code& size : sizes) {
+               dims.push_back(I.visit_arraysize(size()));
+            }
+            if (celltype == 0) {
+               _error(_T("El tipo '%s' no existe", d->typespec->typestr().c_str()));
+            }
+            Type *arraytype = (dims.size() == 1 
+                               ? (Type*)Array::mkarray(celltype, dims[0])
+                               : (Type*)MultiArray::mkarray(celltype, dims));
+            _frame[k] = (v.is_null() ? arraytype->create() : arraytype->convert(v));
+         });
+      } else {
+         ObjDecl *d = dynamic_cast<ObjDecl*>(item.decl);
+         Code init = (item.init ? code(item.init) : Code());
+         vector<Code> args;
+         for (Expr *arg : d->args) {
+            args.push_back(code(arg));
+         }
+         Type *type = Type::get(d->typespec);
+         items.push_back([this, d, k, init, args, type]() {
+            if (init) {
+               init();
+            }
+            if (type == 0) {
+               _error(_T("The type '%s' is not implemented in MiniCC",
+                         d->typespec->typestr().c_str()));
+            }
+            vector<Value> vals;
+            for (const Code& arg : args) {
+               vals.push_back(arg());
+            }
+            try {
+               _frame[k] = type->construct(vals);
+            } catch (TypeError& e) {
+               _error(e.msg);
+            }
+         });
+      }
+   }
+   _action = [items]() {
+      for (const Action& item : items) {
+         item();
+      }
+   };
+}
+
+void ClosureCompiler::visit_exprstmt(ExprStmt *x) {
+   if (x->expr == 0) {
+      _action = []() {};
+   } else if (x->is_return) {
+      Code e = code(x->expr);
+      _action = [this, e]() { I._ret = e(); };
+   } else {
+      _action = effect(x->expr);
+   }
+}
+
+void ClosureCompiler::visit_ifstmt(IfStmt *x) {
+   Test cond = test(x->cond, [this]() {
+      _error(_T("An if's condition needs to be a bool value"));
+   });
+   Action then = action(x->then);
+   Action els  = (x->els ? action(x->els) : Action());
+   _action = [cond, then, els]() {
+      if (cond()) {
+         then();
+      } else if (els) {
+         els();
+      }
+   };
+}
+
+void ClosureCompiler::visit_iterstmt(IterStmt *x) {
+   _scopes.push_back(Scope());
+   declare(x->init);
+   declare(x->substmt);
+   Action init = (x->init ? action(x->init) : Action());
+   Test   cond = test(x->cond, [this, x]() {
+      _error(_T("La condición de un '%s' debe ser un valor de tipo bool.",
+                (x->is_for() ? "for" : "while")));
+   });
+   const int breaks = _breaks;
+   Action body = action(x->substmt);
+   Action post = (x->post ? effect(x->post) : Action());
+   vector<int> slots;
+   for (auto& s : _scopes.back()) {
+      slots.push_back(s.second);
+   }
+   _scopes.pop_back();
+   const bool may_break = (_breaks > breaks);
+   _action = [this, init, cond, body, post, slots, may_break]() {
+      if (init) {
+         init();
+      }
+      while (cond()) {
+         body();
+         if (may_break and I._break) {
+            I._break = false;
+            break;
+         }
+         if (post) {
+            post();
+         }
+      }
+      // The loop's environment disappears
+      for (int k : slots) {
+         _frame[k] = Value::null;
+      }
+   };
+}
+
+void ClosureCompiler::visit_switchstmt(SwitchStmt *x) {
+   _scopes.push_back(Scope());
+   for (SwitchStmt::Case& c : x->cases) {
+      for (Stmt *stmt : c.stmts) {
+         declare(stmt);
+      }
+   }
+   Code cond = value(x->cond);
+   // The statements of all cases in a row, so that falling through to the
+   // next case is just going on
+   vector<Action> stmts;
+   vector<int> first; // first statement of each case
+   for (SwitchStmt::Case& c : x->cases) {
+      first.push_back(stmts.size());
+      for (Stmt *stmt : c.stmts) {
+         stmts.push_back(action(stmt));
+      }
+   }
+   vector<int> slots;
+   for (auto& s : _scopes.back()) {
+      slots.push_back(s.second);
+   }
+   _scopes.pop_back();
+   _action = [this, x, cond, stmts, first, slots]() {
+      const int val = I.visit_switchstmt_value(cond());
+      if (x->table == 0) {
+         x->table = I.visit_switchstmt_table(x);
+      }
+      const int k = x->table->find(val);
+      if (k < 0) {
+         return;
+      }
+      for (int i = first[k]; i < stmts.size(); i++) {
+         stmts[i]();
+         if (I._break) {
+            break;
+         }
+      }
+      I._break = false;
+      for (int s : slots) {
+         _frame[s] = Value::null;
+      }
+   };
+}
+
+void ClosureCompiler::visit_jumpstmt(JumpStmt *x) {
+   _breaks++;
+   _action = [this, x]() { x->accept(&I); };
+}
+
+void ClosureCompiler::visit_errorstmt(Stmt::Error *x) {
+   _action = [this, x]() { x->accept(&I); };
+}
+
+// Expressions //////////////////////////////////////////////////////
+
+void ClosureCompiler::visit_ident(Ident *x) {
+   _code = ident(x, true);
+}
+
+void ClosureCompiler::visit_literal(Literal *x) {
+   Value v = literal_value(x);
+   if (v.is_null()) {
+      _code = [this, x]() { x->accept(&I); return I._curr; };
+      return;
+   }
+   _code = [v]() { return v.clone(); };
+}
+
+Value ClosureCompiler::binaryexpr_op(BinaryExpr *x, const Value& left, const Value& right) {
+   I.visit_binaryexpr_op(x, left, right);
+   return I._curr;
+}
+
+template<class Op>
+ClosureCompiler::Code ClosureCompiler::sumprod(BinaryExpr *x) {
+   Code left = operand(x->left), right = operand(x->right);
+   return [this, x, left, right]() -> Value {
+      Value a = left(), b = right();
+      if (both<Int>(a, b)) {
+         return Value(Op::eval(Int::cast(a.data()), Int::cast(b.data())));
+      }
+      if (both<Double>(a, b)) {
+         return Value(Op::eval(Double::cast(a.data()), Double::cast(b.data())));
+      }
+      return binaryexpr_op(x, a, b);
+   };
+}
+
+template<class Op>
+ClosureCompiler::Code ClosureCompiler::bitop(BinaryExpr *x) {
+   Code left = operand(x->left), right = operand(x->right);
+   return [this, x, left, right]() -> Value {
+      Value a = left(), b = right();
+      if (both<Int>(a, b)) {
+         return Value(Op::eval(Int::cast(a.data()), Int::cast(b.data())));
+      }
+      return binaryexpr_op(x, a, b);
+   };
+}
+
+template<class Op>
+ClosureCompiler::Code ClosureCompiler::comparison(BinaryExpr *x) {
+   Test t = comparison_test<Op>(x);
+   return [t]() { return Value(t()); };
+}
+
+template<class Op>
+ClosureCompiler::Test ClosureCompiler::comparison_test(BinaryExpr *x) {
+   Code left = operand(x->left), right = operand(x->right);
+   return [this, x, left, right]() -> bool {
+      Value a = left(), b = right();
+      if (both<Int>(a, b)) {
+         return Op::eval(Int::cast(a.data()), Int::cast(b.data()));
+      }
+      if (both<Double>(a, b)) {
+         return Op::eval(Double::cast(a.data()), Double::cast(b.data()));
+      }
+      Value r = binaryexpr_op(x, a, b);
+      return r.data() != 0 and Bool::cast(r.data());
+   };
+}
+
+ClosureCompiler::Test ClosureCompiler::binaryexpr_test(BinaryExpr *x) {
+   const string& op = x->op;
+   if (op == "&&" or op == "and" or op == "||" or op == "or") {
+      // Both sides are evaluated, as in the Interpreter
+      Test left  = binaryexpr_test(dynamic_cast<BinaryExpr*>(x->left));
+      Test right = binaryexpr_test(dynamic_cast<BinaryExpr*>(x->right));
+      if (op == "&&" or op == "and") {
+         return [left, right]() { bool a = left(), b = right(); return a and b; };
+      } else {
+         return [left, right]() { bool a = left(), b = right(); return a or b; };
+      }
+   }
+   if (op == "<")  return comparison_test<_Lt>(x);
+   if (op == "<=") return comparison_test<_Le>(x);
+   if (op == ">")  return comparison_test<_Gt>(x);
+   if (op == ">=") return comparison_test<_Ge>(x);
+   if (op == "==") return comparison_test<_Eq>(x);
+   assert(op == "!=");
+   return comparison_test<_Ne>(x);
+}
+
+ClosureCompiler::Code ClosureCompiler::binaryexpr_stream(BinaryExpr *x) {
+   Code left = code(x->left);
+   if (x->op == "<<") {
+      Code right = operand(x->right);
+      return [this, x, left, right]() -> Value {
+         Value a = left();
+         if (Reference::deref(a) == Cout) {
+            I.out() << right();
+            return a;
+         }
+         return binaryexpr_op(x, Reference::deref(a), right());
+      };
+   }
+   Code right = value(x->right);
+   Ident *id = dynamic_cast<Ident*>(x->right);
+   if (id == 0) {
+      return [this, x, left, right]() -> Value {
+         Value a = left();
+         if (Reference::deref(a) == Cin) {
+            _error(_T("La lectura con 'cin' requiere que pongas variables"));
+         }
+         return binaryexpr_op(x, Reference::deref(a), right());
+      };
+   }
+   Binding b = bind(id->name);
+   return [this, x, left, right, b]() -> Value {
+      Value a = left();
+      if (Reference::deref(a) == Cin) {
+         Value v;
+         if (!find(b, false, v)) {
+            _error(_T("La variable '%s' no está declarada", b.name.c_str()));
+         }
+         I.in() >> v;
+         return a;
+      }
+      return binaryexpr_op(x, Reference::deref(a), right());
+   };
+}
+
+void ClosureCompiler::visit_binaryexpr(BinaryExpr *x) {
+   const string& op = x->op;
+   if (x->kind == Expr::Assignment) {
+      _code = binaryexpr_assignment(x, false);
+   } else if (op == "<<" or op == ">>") {
+      _code = binaryexpr_stream(x);
+   }
+   else if (op == "+")  _code = sumprod<_Add>(x);
+   else if (op == "-")  _code = sumprod<_Sub>(x);
+   else if (op == "*")  _code = sumprod<_Mul>(x);
+   else if (op == "/")  _code = sumprod<_Div>(x);
+   else if (op == "%")  _code = bitop<_Mod>(x);
+   else if (op == "&")  _code = bitop<_And>(x);
+   else if (op == "|")  _code = bitop<_Or >(x);
+   else if (op == "^")  _code = bitop<_Xor>(x);
+   else if (op == "<")  _code = comparison<_Lt>(x);
+   else if (op == "<=") _code = comparison<_Le>(x);
+   else if (op == ">")  _code = comparison<_Gt>(x);
+   else if (op == ">=") _code = comparison<_Ge>(x);
+   else if (op == "==") _code = comparison<_Eq>(x);
+   else if (op == "!=") _code = comparison<_Ne>(x);
+   else {
+      Code left = operand(x->left), right = operand(x->right);
+      _code = [this, x, left, right]() {
+         Value a = left();
+         return binaryexpr_op(x, a, right());
+      };
+   }
+}
+
+template<class Op>
+ClosureCompiler::Code ClosureCompiler::op_assignment(BinaryExpr *x, bool discard) {
+   const bool place = is_place(x->left);
+   Code left  = (place ? value(x->left) : code(x->left));
+   Code right = (discard ? value(x->right) : code(x->right));
+   return [this, x, place, left, right]() -> Value {
+      Value a = left(), r = right();
+      Value b = Reference::deref(r);
+      if (place and both<Int>(a, b)) {
+         Op::eval(Int::cast(a.data()), Int::cast(b.data()));
+      } else if (place and both<Double>(a, b)) {
+         Op::eval(Double::cast(a.data()), Double::cast(b.data()));
+      } else {
+         binaryexpr_op(x, (place ? Reference::mkref(a) : a), b);
+      }
+      return r;
+   };
+}
+
+template<class Op>
+ClosureCompiler::Code ClosureCompiler::bitop_assignment(BinaryExpr *x, bool discard) {
+   const bool place = is_place(x->left);
+   Code left  = (place ? value(x->left) : code(x->left));
+   Code right = (discard ? value(x->right) : code(x->right));
+   return [this, x, place, left, right]() -> Value {
+      Value a = left(), r = right();
+      Value b = Reference::deref(r);
+      if (place and both<Int>(a, b)) {
+         Op::eval(Int::cast(a.data()), Int::cast(b.data()));
+      } else {
+         binaryexpr_op(x, (place ? Reference::mkref(a) : a), b);
+      }
+      return r;
+   };
+}
+
+ClosureCompiler::Code ClosureCompiler::binaryexpr_assignment(BinaryExpr *x, bool discard) {
+   const string& op = x->op;
+   if (op == "+=") return op_assignment<_AAdd>(x, discard);
+   if (op == "-=") return op_assignment<_ASub>(x, discard);
+   if (op == "*=") return op_assignment<_AMul>(x, discard);
+   if (op == "/=") return op_assignment<_ADiv>(x, discard);
+   if (op == "%=") return bitop_assignment<_AMod>(x, discard);
+   if (op == "&=") return bitop_assignment<_AAnd>(x, discard);
+   if (op == "|=") return bitop_assignment<_AOr >(x, discard);
+   if (op == "^=") return bitop_assignment<_AXor>(x, discard);
+
+   const bool place = (op == "=" and is_place(x->left));
+   Code left  = (place ? value(x->left) : code(x->left));
+   Code right = value(x->right);
+   if (op != "=") {
+      return [this, x, left, right]() {
+         Value a = left();
+         return binaryexpr_op(x, a, right());
+      };
+   }
+   Code assign = [this, place, left, right]() -> Value {
+      Value a = left(), b = right();
+      if (place and both<Int>(a, b)) {
+         Int::cast(a.data()) = Int::cast(b.data());
+         return a;
+      }
+      if (place and both<Double>(a, b)) {
+         Double::cast(a.data()) = Double::cast(b.data());
+         return a;
+      }
+      I.visit_binaryexpr_assignment((place ? Reference::mkref(a) : a), b);
+      return I._curr;
+   };
+   if (x->inplace != BinaryExpr::NotInPlace) {
+      return inplace_assignment(x, assign);
+   }
+   return assign;
+}
+
+// As in Interpreter::visit_binaryexpr_inplace, with 'assign' for
+// non-strings
+ClosureCompiler::Code ClosureCompiler::inplace_assignment(BinaryExpr *x, Code assign) {
+   if (x->inplace == BinaryExpr::Append) {
+      BinaryExpr *sum = static_cast<BinaryExpr*>(x->right);
+      Code target = code(x->left), piece = value(sum->right);
+      return [this, sum, target, piece, assign]() -> Value {
+         Value t = target();
+         Value s = Reference::deref(t);
+         if (!s.is<String>() or s.data() == 0) {
+            return assign();
+         }
+         I.visit_string_append(sum, t, piece());
+         return I._curr;
+      };
+   }
+   IndexExpr *cell = static_cast<IndexExpr*>(x->left);
+   Code base = value(cell->base), index = value(cell->index), right = value(x->right);
+   return [this, base, index, right, assign]() -> Value {
+      Value s = base();
+      if (!s.is<String>() or s.data() == 0) {
+         return assign();
+      }
+      Value i = index();
+      I.visit_string_store(s, i, right());
+      return I._curr;
+   };
+}
+
+void ClosureCompiler::visit_callexpr(CallExpr *x) {
+   vector<Code> args;
+   for (Expr *arg : x->args) {
+      args.push_back(code(arg));
+   }
+   FieldExpr *fx = dynamic_cast<FieldExpr*>(x->func);
+   if (fx == 0) {
+      Code func = value(x->func);
+      _code = [this, func, args]() -> Value {
+         Value f = func();
+         if (!f.is<Function>()) {
+            _error(_T("Calling something other than a function."));
+         }
+         return call(f, args);
+      };
+      return;
+   }
+   Code base = value(fx->base);
+   _code = [this, fx, base, args]() -> Value {
+      Value obj = base();
+      if (I.lookup_method(fx, obj)) {
+         const Function *func_type = fx->cache.functype->as<Function>();
+         vector<Value> vals;
+         for (const Code& arg : args) {
+            vals.push_back(arg());
+         }
+         I.visit_callexpr_check(func_type, vals);
+         I._ret = I.call_method(fx->cache.method, obj.data(), vals);
+         if (I._ret == Value::null && !func_type->is_void()) {
+            _error(_T("La función '%s' debería devolver un '%s'",
+                      fx->field->name.c_str(),
+                      func_type->return_type()->typestr().c_str()));
+         }
+         return I._ret;
+      }
+      I.visit_fieldexpr_obj(fx, obj);
+      Value f = Reference::deref(I._curr);
+      if (!f.is<Function>()) {
+         _error(_T("Calling something other than a function."));
+      }
+      return call(f, args);
+   };
+}
+
+ClosureCompiler::Code ClosureCompiler::indexexpr(IndexExpr *x, bool ref) {
+   Code base = value(x->base), index = operand(x->index);
+   const Type *seen = 0; // the last type of base that was checked
+   Code code = [this, base, index, ref, seen]() mutable -> Value {
+      Value b = base();
+      if (seen == 0 or b.type() != seen) {
+         if (b.is<Map>()) {
+            I.visit_indexexpr_key(b, index());
+            return (ref ? I._curr : Reference::deref(I._curr));
+         }
+         if (b.is<Adapter>()) {
+            I.visit_indexexpr_deque(b, index());
+            return (ref ? I._curr : Reference::deref(I._curr));
+         }
+         if (b.is<String>()) {
+            I.visit_indexexpr_char(b, index());
+            return I._curr;
+         }
+         if (b.is<MultiArray>()) {
+            I.visit_indexexpr_row(b, index());
+            return I._curr;
+         }
+         if (b.is<Pointer>()) {
+            I.visit_indexexpr_ptr(b, index());
+            return (ref ? I._curr : Reference::deref(I._curr));
+         }
+         if (!b.is<Array>() and !b.is<Vector>()) {
+            _error(_T("Las expresiones de índice deben usarse sobre tablas o vectores"));
+         }
+         seen = b.type();
+      }
+      vector<Value>& vals = *static_cast<vector<Value>*>(b.data());
+      Value i = index();
+      if (!i.is<Int>()) {
+         _error(_T("El índice en un acceso a tabla debe ser un entero"));
+      }
+      const int k = Int::cast(i.data());
+      if (k < 0 || k >= vals.size()) {
+         _error(_T("La casilla %d no existe", k));
+      }
+      return (ref ? Reference::mkref(vals[k]) : vals[k]);
+   };
+   return (x->chain > 1 ? cellexpr(x, ref, code) : code);
+}
+
+// 'a[i][j]...' on a table of as many dimensions: one offset into its
+// cells (anything else goes to 'code', which indexes one level at a time)
+ClosureCompiler::Code ClosureCompiler::cellexpr(IndexExpr *x, bool ref, Code code) {
+   const int n = x->chain;
+   vector<Code> indices(n);
+   Expr *root = x;
+   for (int k = n - 1; k >= 0; k--) {
+      IndexExpr *cell = static_cast<IndexExpr*>(root);
+      indices[k] = operand(cell->index);
+      root = cell->base;
+   }
+   Code base = value(root);
+   const Type *other = 0; // the last type of base that was not a table of n dimensions
+   return [this, n, base, indices, ref, code, other]() mutable -> Value {
+      Value b = base();
+      if (b.is_null() or b.type() == other) {
+         return code();
+      }
+      const MultiArray *multi = b.type()->as<MultiArray>();
+      if (multi == 0 or multi->rank() != n) {
+         other = b.type();
+         return code();
+      }
+      vector<Value>& cells = *static_cast<vector<Value>*>(b.data());
+      int offset = 0;
+      for (int k = 0; k < n; k++) {
+         Value i = indices[k]();
+         if (i.type() != Int::self) {
+            _error(_T("El índice en un acceso a tabla debe ser un entero"));
+         }
+         const int j = Int::cast(i.data());
+         if (j < 0 || j >= multi->dim(k)) {
+            _error(_T("La casilla %d no existe", j));
+         }
+         offset = offset * multi->dim(k) + j;
+      }
+      return (ref ? Reference::mkref(cells[offset]) : cells[offset]);
+   };
+}
+
+void ClosureCompiler::visit_indexexpr(IndexExpr *x) {
+   _code = indexexpr(x, true);
+}
+
+void ClosureCompiler::visit_fieldexpr(FieldExpr *x) {
+   Code base = value(x->base);
+   _code = [this, x, base]() {
+      I.visit_fieldexpr_obj(x, base());
+      return I._curr;
+   };
+}
+
+void ClosureCompiler::visit_condexpr(CondExpr *x) {
+   Code cond = code(x->cond), then = code(x->then);
+   Code els  = (x->els ? code(x->els) : Code());
+   _code = [this, cond, then, els]() -> Value {
+      Value c = cond();
+      if (!c.is<Bool>()) {
+         _error(_T("Una expresión condicional debe tener valor "
+                   "de tipo 'bool' antes del interrogante"));
+      }
+      if (c.as<Bool>()) {
+         return then();
+      }
+      return (els ? els() : c);
+   };
+}
+
+void ClosureCompiler::visit_exprlist(ExprList *x) {
+   vector<Code> exprs;
+   for (Expr *e : x->exprs) {
+      exprs.push_back(code(e));
+   }
+   _code = [exprs]() {
+      Value v = VectorValue::make();
+      vector<Value>& vals = v.as<VectorValue>();
+      for (const Code& e : exprs) {
+         vals.push_back(e());
+      }
+      return v;
+   };
+}
+
+void ClosureCompiler::visit_signexpr(SignExpr *x) {
+   if (x->kind == SignExpr::Positive) {
+      _code = code(x->expr);
+      return;
+   }
+   Code e = value(x->expr);
+   _code = [this, e]() {
+      Value v = e();
+      if (v.is<Int>()) {
+         v.as<Int>() = -v.as<Int>();
+      } else if (v.is<Float>()) {
+         v.as<Float>() = -v.as<Float>();
+      } else if (v.is<Double>()) {
+         v.as<Double>() = -v.as<Double>();
+      } else {
+         _error(_T("El cambio de signo para '%s' no tiene sentido",
+                   v.type_name().c_str()));
+      }
+      return v;
+   };
+}
+
+ClosureCompiler::Code ClosureCompiler::increxpr(IncrExpr *x, bool discard) {
+   const bool place = is_place(x->expr);
+   const bool positive = (x->kind == IncrExpr::Positive);
+   const bool preincr = x->preincr;
+   Code e = (place ? value(x->expr) : code(x->expr));
+   return [this, e, place, positive, preincr, discard]() -> Value {
+      Value after = e();
+      if (!place) {
+         if (!after.is<Reference>()) {
+            _error(_T("Hay que incrementar una variable, no un valor"));
+         }
+         after = Reference::deref(after);
+      }
+      if (!after.is<Int>()) {
+         _error(_T("Estás incrementando un valor de tipo '%s'",
+                   after.type_name().c_str()));
+      }
+      Value result = (preincr or discard ? after : after.clone());
+      int& i = Int::cast(after.data());
+      if (positive) {
+         i++;
+      } else {
+         i--;
+      }
+      return result;
+   };
+}
+
+void ClosureCompiler::visit_increxpr(IncrExpr *x) {
+   _code = increxpr(x, false);
+}
+
+void ClosureCompiler::visit_negexpr(NegExpr *x) {
+   Code e = code(x->expr);
+   _code = [this, e]() {
+      Value v = e();
+      if (!v.is<Bool>()) {
+         _error(_T("Para negar una expresión ésta debe ser de tipo 'bool'"));
+      }
+      v.as<Bool>() = !v.as<Bool>();
+      return v;
+   };
+}
+
+void ClosureCompiler::visit_addrexpr(AddrExpr *x) {
+   Code place = code(x->expr);
+   _code = [this, place]() { I.visit_addrexpr_place(place()); return I._curr; };
+}
+
+void ClosureCompiler::visit_newexpr(NewExpr *x) {
+   Code size = (x->size ? code(x->size) : Code());
+   Code init = (x->init ? value(x->init) : Code());
+   _code = [this, x, size, init]() { 
+      I.visit_newexpr_block(x, (size ? size() : Value()), (init ? init() : Value()));
+      return I._curr; 
+   };
+}
+
+void ClosureCompiler::visit_deleteexpr(DeleteExpr *x) {
+   Code ptr = value(x->expr);
+   _code = [this, x, ptr]() { I.visit_deleteexpr_ptr(x, ptr()); return I._curr; };
+}
+
+void ClosureCompiler::visit_derefexpr(DerefExpr *x) {
+   Code ptr = value(x->expr);
+   _code = [this, ptr]() { I.visit_derefexpr_ptr(ptr()); return I._curr; };
+}
+
+void ClosureCompiler::visit_errorexpr(Expr::Error *x) {
+   _code = [this, x]() { x->accept(&I); return I._curr; };
+}
@@ -0,0 +1,138 @@
+#ifndef CLOSURES_HH
+#define CLOSURES_HH
+
+#include <assert.h>
+#include <iostream>
+#include <functional>
+#include <vector>
+#include <map>
+
+#include "ast.hh"
+#include "value.hh"
+#include "types.hh"
+#include "interpreter.hh"
+
+// The ClosureCompiler runs a program (minicc --closures) by turning each
+// function, the first time it is called, into a tree of pre-bound C++
+// closures. Local variables are resolved at compile time to slots in a
+// frame, and the common operations on 'int' and 'double' are instantiated
+// from the operator functors of the Interpreter. Everything else is
+// delegated to the Interpreter, so that results and errors are the same.
+
+class ClosureCompiler : public AstVisitor {
+public:
+   typedef std::function<Value ()> Code;   // evaluates an expression
+   typedef std::function<bool ()>  Test;   // evaluates a condition
+   typedef std::function<void ()>  Action; // executes a statement
+
+private:
+   Interpreter I;
+
+   // A call in progress which declares a certain name, and its slots 
+   // for it (innermost scope first).
+   struct Active {
+      Value                  *frame;
+      const std::vector<int> *slots;
+   };
+   typedef std::vector<Active> Callers;
+   std::map<std::string, Callers> _active; // indexed by name
+
+   struct Func {
+      Action           body;
+      int              nslots;
+      std::vector<int> params; // slot of each parameter
+      std::vector<std::pair<Callers*, std::vector<int>>> names; // declared names
+   };
+   std::map<FuncDecl*, Func*> _funcs;
+   Value *_frame; // slots of the function being executed
+
+   // There is a Scope for every environment the Interpreter would push
+   // (the function and each loop), with one slot per declared name.
+   typedef std::map<std::string, int> Scope;
+   std::vector<Scope> _scopes;
+   std::vector<bool>  _refslots; // slots which may hold a Reference
+   std::map<std::string, std::vector<int>> _declared; // slots of each name
+
+   // Where a name is found at runtime: in the first slot that has a
+   // value (innermost scope first), then in the calls in progress (the
+   // Interpreter looks up names dynamically) or else in the global
+   // environment.
+   struct Binding {
+      std::string      name;
+      std::vector<int> slots;
+      Callers         *callers;
+      Value            global, globalref;
+   };
+
+   Code   _code;
+   Action _action;
+   int    _breaks; // 'break's compiled so far (a block without any is faster)
+
+   void  _error(std::string msg) { I._error(msg); }
+
+   Func *function(FuncDecl *x);
+   void  invoke(FuncDecl *x, const std::vector<Value>& args);
+  Value  call(Value func, const std::vector<Code>& args);
+
+   void  declare(Stmt *x);
+    int  slot(std::string name);
+Binding  bind(std::string name);
+   bool  find(const Binding& b, bool ref, Value& v);
+  Value  lookup(const Binding& b, bool ref);
+
+   Code  code(Expr *x);     // same result as the Interpreter (with References)
+   Code  value(Expr *x);    // dereferenced result
+   Code  operand(Expr *x);  // dereferenced, read-only (literals are shared)
+   Test  test(Expr *x, std::function<void ()> fail);
+ Action  action(Stmt *x);
+ Action  effect(Expr *x);   // expression whose value is discarded
+
+  Value  binaryexpr_op(BinaryExpr *x, const Value& left, const Value& right);
+   Code  binaryexpr_stream(BinaryExpr *x);
+   Code  binaryexpr_assignment(BinaryExpr *x, bool discard);
+   Code  inplace_assignment(BinaryExpr *x, Code assign);
+   Test  binaryexpr_test(BinaryExpr *x);
+   Code  indexexpr(IndexExpr *x, bool ref);
+   Code  cellexpr(IndexExpr *x, bool ref, Code code);
+   Code  increxpr(IncrExpr *x, bool discard);
+   Code  ident(Ident *x, bool ref);
+
+   template<class Op> Code  sumprod(BinaryExpr *x);
+   template<class Op> Code  bitop(BinaryExpr *x);
+   template<class Op> Code  comparison(BinaryExpr *x);
+   template<class Op> Test  comparison_test(BinaryExpr *x);
+   template<class Op> Code  op_assignment(BinaryExpr *x, bool discard);
+   template<class Op> Code  bitop_assignment(BinaryExpr *x, bool discard);
+
+public:
+   ClosureCompiler(std::istream *i, std::ostream *o) : I(i, o), _frame(0), _breaks(0) {}
+
+   void visit_program(Program *x);
+   void visit_block(Block *x);
+   void visit_declstmt(DeclStmt *x);
+   void visit_exprstmt(ExprStmt *x);
+   void visit_ifstmt(IfStmt *x);
+   void visit_iterstmt(IterStmt *x);
+   void visit_switchstmt(SwitchStmt *x);
+   void visit_jumpstmt(JumpStmt *x);
+   void visit_errorstmt(Stmt::Error *x);
+
+   void visit_ident(Ident *x);
+   void visit_literal(Literal *x);
+   void visit_binaryexpr(BinaryExpr *x);
+   void visit_callexpr(CallExpr *x);
+   void visit_indexexpr(IndexExpr *x);
+   void visit_fieldexpr(FieldExpr *x);
+   void visit_condexpr(CondExpr *x);
+   void visit_exprlist(ExprList *x);
+   void visit_signexpr(SignExpr *x);
+   void visit_increxpr(IncrExpr *x);
+   void visit_negexpr(NegExpr *x);
+   void visit_addrexpr(AddrExpr *x);
+   void visit_derefexpr(DerefExpr *x);
+   void visit_newexpr(NewExpr *x);
+   void visit_deleteexpr(DeleteExpr *x);
+   void visit_errorexpr(Expr::Error *x);
+};
+
+#endif
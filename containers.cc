@@ -0,0 +1,130 @@
+#include "containers.hh"
+#include "types.hh"
+using namespace std;
+
+// RingBuffer
+
+void RingBuffer::_grow() {
+   vector<Value> cells(_cells.empty() ? 8 : 2 * _cells.size());
+   for (int i = 0; i < _size; i++) {
+      cells[i] = (*this)[i];
+   }
+   _cells.swap(cells);
+   _head = 0;
+}
+
+void RingBuffer::push_back(const Value& v) {
+   if (_size == _cells.size()) {
+      _grow();
+   }
+   _size++;
+   back() = v;
+}
+
+void RingBuffer::push_front(const Value& v) {
+   if (_size == _cells.size()) {
+      _grow();
+   }
+   _head = (_head + _cells.size() - 1) & (_cells.size() - 1);
+   _size++;
+   front() = v;
+}
+
+void RingBuffer::pop_back() {
+   back() = Value::null;
+   _size--;
+}
+
+void RingBuffer::pop_front() {
+   front() = Value::null;
+   _head = _index(1);
+   _size--;
+}
+
+void RingBuffer::clear() {
+   _cells.clear();
+   _head = _size = 0;
+}
+
+// Heap
+
+bool Heap::_below(const Value& a, const Value& b) const {
+   const Value& x = (_greater ? b : a);
+   const Value& y = (_greater ? a : b);
+   if (x.data() == 0 or y.data() == 0) {
+      return x.less(y); // (uninitialized)
+   }
+   if (x.type() == Int::self and y.type() == Int::self) {
+      return Int::cast(x.data()) < Int::cast(y.data());
+   }
+   if (x.type() == Double::self and y.type() == Double::self) {
+      return Double::cast(x.data()) < Double::cast(y.data());
+   }
+   return x.less(y);
+}
+
+void Heap::push(const Value& v) {
+   int i = _cells.size();
+   _cells.push_back(v);
+   while (i > 0) {
+      int parent = (i - 1) / 2;
+      if (!_below(_cells[parent], _cells[i])) {
+         break;
+      }
+      swap(_cells[parent], _cells[i]);
+      i = parent;
+   }
+}
+
+void Heap::pop() {
+   swap(_cells.front(), _cells.back());
+   _cells.pop_back();
+   const int n = _cells.size();
+   int i = 0;
+   while (true) {
+      int top = i, left = 2 * i + 1, right = 2 * i + 2;
+      if (left < n and _below(_cells[top], _cells[left])) {
+         top = left;
+      }
+      if (right < n and _below(_cells[top], _cells[right])) {
+         top = right;
+      }
+      if (top == i) {
+         break;
+      }
+      swap(_cells[i], _cells[top]);
+      i = top;
+   }
+}
+
+// Arena
+
+unsigned Arena::_last_tag = 0;
+
+int Arena::alloc(int ncells, bool array) {
+   int block;
+   if (_free.empty()) {
+      block = _blocks.size();
+      _blocks.push_back(Block());
+   } else {
+      block = _free.back();
+      _free.pop_back();
+   }
+   Block& b = _blocks[block];
+   b.tag   = ++_last_tag;
+   b.array = array;
+   b.cells.resize(ncells);
+   return block;
+}
+
+void Arena::release(int block) {
+   Block& b = _blocks[block];
+   b.tag = 0;
+   b.cells.clear();
+   _free.push_back(block);
+}
+
+void Arena::clear() {
+   _blocks.clear();
+   _free.clear();
+}
@@ -0,0 +1,83 @@
+#ifndef CONTAINERS_HH
+#define CONTAINERS_HH
+
+#include <vector>
+#include "value.hh"
+
+// The storage of deque, stack and queue: a ring buffer over a power-of-two
+// number of cells, so that both ends grow and shrink in constant time.
+class RingBuffer {
+   std::vector<Value> _cells;
+   int _head, _size;
+
+   int  _index(int i) const { return (_head + i) & (_cells.size() - 1); }
+   void _grow();
+
+public:
+   RingBuffer() : _head(0), _size(0) {}
+
+     int  size()               const { return _size; }
+   Value& operator[](int i)          { return _cells[_index(i)]; }
+   const Value& operator[](int i) const { return _cells[_index(i)]; }
+   Value& front()                    { return (*this)[0]; }
+   Value& back()                     { return (*this)[_size - 1]; }
+
+    void  push_back(const Value& v);
+    void  push_front(const Value& v);
+    void  pop_back();
+    void  pop_front();
+    void  clear();
+};
+
+// The storage of priority_queue: a binary heap with the largest cell on
+// top (or the smallest one, for 'greater'). Cells of type int or double
+// are compared natively.
+class Heap {
+   std::vector<Value> _cells;
+   bool _greater;
+
+   bool _below(const Value& a, const Value& b) const; // a goes below b
+
+public:
+   Heap(bool greater = false) : _greater(greater) {}
+
+     int  size()     const { return _cells.size(); }
+    bool  greater()  const { return _greater; }
+   const std::vector<Value>& cells() const { return _cells; } // in heap order
+   const Value& top() const { return _cells.front(); }
+
+    void  push(const Value& v);
+    void  pop();
+};
+
+// The memory of 'new' and 'delete' during one run. Blocks never move (a
+// pointer holds the index of its block) and every block gets a new tag 
+// when allocated and loses it when deleted, so a pointer into a deleted
+// block fails a single comparison. Everything is freed at once, with 
+// 'clear', when the run ends.
+class Arena {
+   struct Block {
+      unsigned tag;   // 0 when deleted
+      bool     array; // from 'new T[n]'
+      std::vector<Value> cells;
+      Block() : tag(0), array(false) {}
+   };
+   std::vector<Block> _blocks;
+   std::vector<int>   _free; // deleted blocks, to be reused
+
+   static unsigned _last_tag; // (never reset, so tags are not reused)
+
+public:
+   int   alloc(int ncells, bool array); // returns the block
+   void  release(int block);
+   void  clear();
+
+   unsigned  tag(int block)   const { return _blocks[block].tag; }
+       bool  array(int block) const { return _blocks[block].array; }
+       bool  live(int block, unsigned tag) const { 
+          return block < _blocks.size() and _blocks[block].tag == tag; 
+       }
+   std::vector<Value>& cells(int block) { return _blocks[block].cells; }
+};
+
+#endif
@@ -63,7 +63,7 @@ void FlowControl::visit_using(Using* x) {
 void FlowControl::visit_funcdecl(FuncDecl *x) {
    if (x->block) {
       //initialize function declaration-related variables:
-      returns_void = x->return_typespec->id->name.compare("void") == 0;
+      returns_void = x->return_typespec->id->name == "void";
       param_by_nonconst_ref = false;
       for (int i = 0; i < x->params.size(); i++) {
          TypeSpec* param_type = x->params[i]->typespec;
@@ -78,7 +78,7 @@ void FlowControl::visit_funcdecl(FuncDecl *x) {
 
       x->block->accept(this);
 
-      if (not returns_void and not has_some_return and x->id->name.compare("main") != 0) {
+      if (not returns_void and not has_some_return and x->id->name != "main") {
          add_error(x, "function '"+x->id->name+"' does not have any return statement");
       }
 
@@ -251,6 +251,9 @@ void FlowControl::visit_vardecl(VarDecl *x) {
 void FlowControl::visit_arraydecl(ArrayDecl *x) {
    //out) << '"' << x->name << "\"(Size = ";
    x->size->accept(this);
+   for (Expr *size : x->subsizes) {
+      size->accept(this);
+   }
    /*
    if (x->init) {
       //out) << ", Init = ";
@@ -382,6 +385,20 @@ void FlowControl::visit_iterstmt(IterStmt *x) {
    is_bool_lit_expr = is_bool_lit_expr_copy;
 }
 
+void FlowControl::visit_switchstmt(SwitchStmt *x) {
+   x->cond->accept(this);
+   bool inside_switch_copy = inside_switch;
+   inside_switch = true;
+   for (SwitchStmt::Case& c : x->cases) {
+      for (Stmt *s : c.stmts) {
+         s->accept(this);
+      }
+   }
+   inside_switch = inside_switch_copy;
+   is_return = false;
+   is_break = false; // (a 'break' leaves just the switch)
+}
+
 void FlowControl::visit_jumpstmt(JumpStmt *x) {
    string keyword[3] = { "break", "continue", "goto" };
    string kind = keyword[x->kind];
@@ -391,7 +408,7 @@ void FlowControl::visit_jumpstmt(JumpStmt *x) {
    if (kind == "goto" or kind == "break") {
       has_exit_stmt = true;
    }
-   if (kind == "break" and not inside_loop) {
+   if (kind == "break" and not inside_loop and not inside_switch) {
       add_error(x, "break statement outside loop");
    }
    if (kind == "continue" and not inside_loop) {
@@ -494,6 +511,19 @@ void FlowControl::visit_derefexpr(DerefExpr *x) {
    //out) << ")";
 }
 
+void FlowControl::visit_newexpr(NewExpr *x) {
+   if (x->size) {
+      x->size->accept(this);
+   }
+   if (x->init) {
+      x->init->accept(this);
+   }
+}
+
+void FlowControl::visit_deleteexpr(DeleteExpr *x) {
+   x->expr->accept(this);
+}
+
 void FlowControl::visit_errorstmt(Stmt::Error *x) {
    //out) << "ErrorStmt(\"" << x->code << "\")";
 }
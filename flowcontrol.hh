@@ -50,7 +50,7 @@ class FlowControl : public AstVisitor, public ReadWriter {
 
 public:
    FlowControl(std::ostream *o = &std::cout) 
-      : ReadWriter(o) {
+      : ReadWriter(o), inside_loop(false), inside_switch(false) {
 
       }
 
@@ -76,6 +76,7 @@ public:
    void visit_exprstmt(ExprStmt *x);
    void visit_ifstmt(IfStmt *x);
    void visit_iterstmt(IterStmt *x);
+   void visit_switchstmt(SwitchStmt *x);
    void visit_jumpstmt(JumpStmt *x);
    void visit_callexpr(CallExpr *x);
    void visit_indexexpr(IndexExpr *x);
@@ -87,6 +88,8 @@ public:
    void visit_negexpr(NegExpr *x);
    void visit_addrexpr(AddrExpr *x);
    void visit_derefexpr(DerefExpr *x);
+   void visit_newexpr(NewExpr *x);
+   void visit_deleteexpr(DeleteExpr *x);
    void visit_literal(Literal *x);
    void visit_paramdecl(ParamDecl *x);
 
@@ -120,6 +123,7 @@ private:
    
    //variables relevant to detect unreacheable instructions after break/continue
    bool inside_loop;
+   bool inside_switch;
    bool is_break;
    bool is_continue;
 
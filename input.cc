@@ -1,6 +1,10 @@
 
 #include <assert.h>
+#include <string.h>
 #include <sstream>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 using namespace std;
 
 #include "input.hh"
@@ -21,7 +25,89 @@ string Pos::str() const {
    return out.str();
 }
 
+struct LexError {};
+
+// Scanning blanks ///////////////////////////////////////////////////
+
+// Each of these returns the first byte in [p, end) which is not a space
+// or a tab (or 'end'). The widest one the CPU has is chosen at startup.
+
+static const char *_skip_blanks_scalar(const char *p, const char *end) {
+   while (p < end and (*p == ' ' or *p == '\t')) {
+      p++;
+   }
+   return p;
+}
+
+#if defined(__SSE2__)
+static const char *_skip_blanks_sse2(const char *p, const char *end) {
+   const __m128i space = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t');
+   for (; p + 16 <= end; p += 16) {
+      __m128i x = _mm_loadu_si128((const __m128i *)p);
+      __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(x, space), _mm_cmpeq_epi8(x, tab));
+      unsigned mask = ~_mm_movemask_epi8(blank) & 0xffff;
+      if (mask != 0) {
+         return p + __builtin_ctz(mask);
+      }
+   }
+   return _skip_blanks_scalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char *_skip_blanks_avx2(const char *p, const char *end) {
+   const __m256i space = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t');
+   for (; p + 32 <= end; p += 32) {
+      __m256i x = _mm256_loadu_si256((const __m256i *)p);
+      __m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(x, space), 
+                                      _mm256_cmpeq_epi8(x, tab));
+      unsigned mask = ~unsigned(_mm256_movemask_epi8(blank));
+      if (mask != 0) {
+         return p + __builtin_ctz(mask);
+      }
+   }
+   return _skip_blanks_sse2(p, end);
+}
+#endif
+
+typedef const char *(*BlankScanner)(const char *, const char *);
+
+static BlankScanner _choose_blank_scanner() {
+#if defined(__SSE2__)
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2")) {
+      return _skip_blanks_avx2;
+   }
+   return _skip_blanks_sse2;
+#else
+   return _skip_blanks_scalar;
+#endif
+}
+
+static const BlankScanner _skip_blanks = _choose_blank_scanner();
+
+// Moves the cursor to 'idx' (ahead of it), counting the lines in between 
+// as next() would have
+void Input::_advance_to(int idx) {
+   assert(_curr >= 0 and idx >= _curr and idx <= _text.size());
+   const char *text = _text.data();
+   const char *p = text + _curr, *end = text + idx, *last = 0;
+   while ((p = (const char *)memchr(p, '\n', end - p)) != 0) {
+      _pos.lin++;
+      last = p++;
+   }
+   if (last != 0) {
+      _pos.col = end - (last + 1);
+      _seen_endl = true;
+   } else {
+      _pos.col += idx - _curr;
+   }
+   _curr = idx;
+}
+
 void Input::error(string msg) {
+   if (_lexing) {
+      throw LexError(); // the parser will find it again (if it gets there)
+   }
    cerr << msg << endl;
    exit(1);
 }
@@ -37,7 +123,7 @@ void Input::consume(string word) {
    }
 }
 
-string Input::substr(const Token& t) {
+string Input::substr(const Token& t) const {
    string s;
    if (t.ini != -1 and t.fin != -1) {
       s = _text.substr(t.ini, t.fin - t.ini);
@@ -45,6 +131,37 @@ string Input::substr(const Token& t) {
    return s;
 }
 
+string Input::str(const Token& t) const {
+   if (t.kind != Token::StringLiteral and t.kind != Token::CharLiteral) {
+      return substr(t);
+   }
+   string s;
+   for (int i = t.ini; i < t.fin; i++) {
+      if (_text[i] != '\\') {
+         s += _text[i];
+         continue;
+      }
+      switch (_text[++i]) {
+      case 'a':  s += '\a'; break;
+      case 'b':  s += '\b'; break;
+      case 'f':  s += '\f'; break;
+      case 'n':  s += '\n'; break;
+      case 'r':  s += '\r'; break;
+      case 't':  s += '\t'; break;
+      case 'v':  s += '\v'; break;
+      case '\'': s += '\''; break;
+      case '\"': s += '\"'; break;
+      case '\?': s += '\?'; break;
+      case '\\': s += '\\'; break;
+      default: 
+         cerr << "warning: unknown escape sequence '\\" 
+              << _text[i] << "'" << endl;
+         s += _text[i];
+      }
+   }
+   return s;
+}
+
 string Input::substr(const Pos& ini, const Pos& fin) const {
    const int i = _pos_to_idx(ini);
    const int j = _pos_to_idx(fin);
@@ -59,9 +176,24 @@ bool Input::curr_one_of(std::string set) const {
 }
 
 CommentSeq* Input::skip(string skip_set) {
+   const int k = _lexeme_at(_curr);
+   if (k >= 0 and _lexemes[k].lead == _curr and skip_set == "\n\t ") {
+      const Lexeme& x = _lexemes[k];
+      _curr = x.ini;
+      _pos  = x.pini;
+      return (x.trivia != 0 ? new CommentSeq(*x.trivia) : 0);
+   }
+   const bool blanks = (skip_set.find(' ') != string::npos and 
+                        skip_set.find('\t') != string::npos);
    CommentSeq *cs = 0;
    int endls_in_a_row = 0;
    while (!end()) {
+      if (blanks and (curr() == ' ' or curr() == '\t')) {
+         const char *text = _text.data();
+         _advance_to(_skip_blanks(text + _curr, text + _text.size()) - text);
+         endls_in_a_row = 0;
+         continue;
+      }
       while (curr() == '/') {
          peek(1);
          if (cs == 0) {
@@ -108,7 +240,7 @@ string Input::skip_to(string stop_set) {
 }
 
 void Input::save() {
-   _stack.push_back(SavedItem(_curr, _pos, _linepos));
+   _stack.push_back(SavedItem(_curr, _pos));
 }
 
 void Input::restore() {
@@ -116,7 +248,6 @@ void Input::restore() {
    SavedItem item = _stack.back();
    _curr    = item.curr;
    _pos     = item.pos;
-   _linepos = item.linepos;
    _stack.pop_back();
 }
 
@@ -125,6 +256,13 @@ void Input::discard() {
 }
 
 Token Input::next_token() {
+   const int k = _lexeme_at(_curr);
+   if (k >= 0 and _lexemes[k].ini == _curr and _lexemes[k].fin > _curr) {
+      const Lexeme& x = _lexemes[k];
+      _curr = x.fin;
+      _pos  = x.pfin;
+      return x.tok;
+   }
    switch (curr()) {
    case '.': 
       if (isdigit(curr(1))) {
@@ -136,22 +274,22 @@ Token Input::next_token() {
    case '[': case ']':
    case '{': case '}':
    case '#': case ';': {
-      string s(1, curr());
-      Token tok(Token::token2type(s));
+      Token tok(Token::token2type(_text.data() + _curr, 1));
+      tok.ini = _curr;
       next();
-      tok.str = s;
+      tok.fin = _curr;
       return tok;
    }
 
    case ':': {
-      next();
       Token tok(Token::Colon);
-      tok.str = ":";
+      tok.ini = _curr;
+      next();
       if (curr() == ':') {
          next();
          tok.kind = Token::ColonColon;
-         tok.str = "::";
       } 
+      tok.fin = _curr;
       return tok;
    }
    case '-': {
@@ -198,6 +336,10 @@ Token Input::next_token() {
 }
 
 Token Input::peek_token() {
+   const int k = _lexeme_at(_curr);
+   if (k >= 0) {
+      return _lexemes[k].tok;
+   }
    save();
    skip("\n\t ");
    Token tok = next_token();
@@ -205,7 +347,38 @@ Token Input::peek_token() {
    return tok;
 }
 
+// The n-th token ahead (peek_token(0) is peek_token()), from the
+// lexemes when they cover it, so that the parser can look a few tokens
+// ahead instead of trying a parse and backtracking
+Token Input::peek_token(int n) {
+   const int k = _lexeme_at(_curr);
+   if (k >= 0 and k + n < _lexemes.size() and
+       _lexemes[k + n].fin > _lexemes[k + n].ini) {
+      return _lexemes[k + n].tok;
+   }
+   save();
+   Token tok;
+   for (int i = 0; i <= n; i++) {
+      delete skip("\n\t ");
+      tok = next_token();
+   }
+   restore();
+   return tok;
+}
+
+// The lexer reads "-1" as one literal, but after an operand the '-' is
+// an operator (and only then is the operator lexed again)
+bool Input::_signed_literal(int k) const {
+   const Token& t = _lexemes[k].tok;
+   return (t.kind == Token::IntLiteral or t.kind == Token::RealLiteral) and
+          _text[t.ini] == '-';
+}
+
 Token Input::peek_operator() {
+   const int k = _lexeme_at(_curr);
+   if (k >= 0 and !_signed_literal(k)) {
+      return _lexemes[k].tok;
+   }
    save();
    skip("\n\t ");
    Token tok = read_operator();
@@ -213,7 +386,180 @@ Token Input::peek_operator() {
    return tok;
 }
 
+// What peek_operator gives (after a skip)
+Token Input::next_operator() {
+   const int k = _lexeme_at(_curr);
+   if (k >= 0 and _lexemes[k].ini == _curr and !_signed_literal(k)) {
+      return next_token();
+   }
+   return read_operator();
+}
+
+Input::Input(istream* i, int first_line, int piece)
+   : _in(i), _first_line(first_line), _piece(piece), _lexing(false) {
+   if (_piece > 0) {
+      _read_piece();
+   } else {
+      _read();
+   }
+   _lex();
+}
+
+// The whole stream in one read when its size is known (a file), or 
+// else everything its buffer gives
+void Input::_read() {
+   const streampos ini = _in->tellg();
+   _in->seekg(0, ios::end);
+   const streampos fin = _in->tellg();
+   if (ini >= 0 and fin >= ini) {
+      _in->seekg(ini);
+      _text.resize(fin - ini);
+      _in->read(&_text[0], _text.size());
+      _text.resize(_in->gcount());
+   } else {
+      _in->clear();
+      ostringstream all;
+      all << _in->rdbuf();
+      _text = all.str();
+   }
+}
+
+// The brackets and multiline comments left open at the end of a line,
+// and its first and last characters outside comments and spaces
+static void _scan_line(const string& line, int& depth, bool& in_comment, 
+                       char& first, char& last) {
+   first = last = 0;
+   for (int i = 0; i < line.size(); i++) {
+      const char c = line[i], d = (i+1 < line.size() ? line[i+1] : 0);
+      if (in_comment) {
+         if (c == '*' and d == '/') {
+            in_comment = false;
+            i++;
+         }
+         continue;
+      }
+      if (c == '/' and d == '/') {
+         break;
+      }
+      if (c == '/' and d == '*') {
+         in_comment = true;
+         i++;
+         continue;
+      }
+      if (c == ' ' or c == '\t' or c == '\n' or c == '\r') {
+         continue;
+      }
+      if (first == 0) {
+         first = c;
+      }
+      last = c;
+      switch (c) {
+      case '"': case '\'':
+         for (i++; i < line.size() and line[i] != c; i++) {
+            if (line[i] == '\\') {
+               i++;
+            }
+         }
+         break;
+      case '(': case '[': case '{': depth++; break;
+      case ')': case ']': case '}': depth--; break;
+      }
+   }
+}
+
+// A piece ends between two top-level declarations, when it has at
+// least '_piece' characters: after a line which closes all brackets and
+// ends in ';' or '}' (or is a macro), and the empty lines and comments
+// that follow it, and before a line that begins with a name or '#'
+void Input::_read_piece() {
+   string line;
+   line.swap(_next_line);
+   _text.clear();
+   int depth = 0;
+   bool in_comment = false, closed = false;
+   while (!line.empty() or getline(*_in, line)) {
+      if (!_in->eof() and (line.empty() or line.back() != '\n')) {
+         line += '\n';
+      }
+      const bool top = (depth == 0 and !in_comment);
+      char first, last;
+      _scan_line(line, depth, in_comment, first, last);
+      if (closed and top and _text.size() >= _piece and 
+          (isalpha((unsigned char)first) or first == '_' or first == '#')) {
+         _next_line.swap(line);
+         return;
+      }
+      _text += line;
+      if (first != 0) {
+         closed = (depth == 0 and !in_comment and 
+                   (last == ';' or last == '}' or (first == '#' and last != '\\')));
+      }
+      line.clear();
+   }
+}
+
+// The text read so far is dropped, so this can only be called between
+// two top-level declarations, when nothing refers to it
+bool Input::next_piece() {
+   if (_piece == 0 or _next_line.empty()) {
+      return false;
+   }
+   assert(end() and _stack.empty());
+   _first_line = _pos.lin;
+   _drop_lexemes();
+   _linepos.clear();
+   _read_piece();
+   _lex();
+   return next();
+}
+
+void Input::_drop_lexemes() {
+   for (Lexeme& x : _lexemes) {
+      delete x.trivia;
+   }
+   _lexemes.clear();
+}
+
+void Input::_lex() {
+   _at.assign(_text.size() + 1, -1);
+   _reset();
+   _lexing = true;
+   try {
+      next();
+      while (true) {
+         Lexeme x;
+         x.lead   = _curr;
+         x.trivia = skip("\n\t ");
+         x.ini    = _curr;
+         x.pini   = _pos;
+         x.tok    = (end() ? Token() : next_token());
+         x.fin    = _curr;
+         x.pfin   = _pos;
+         _at[x.lead] = _at[x.ini] = _lexemes.size();
+         _lexemes.push_back(x);
+         if (x.fin == x.ini) { // the end, or something that isn't a token
+            break;
+         }
+      }
+   } catch (LexError&) {}
+   _lexing = false;
+   _reset();
+}
+
+void Input::_index_lines() const {
+   _linepos.assign(2, 0);
+   const char *text = _text.data(), *end = text + _text.size();
+   for (const char *p = text; (p = (const char *)memchr(p, '\n', end - p)) != 0; ) {
+      p++;
+      _linepos.push_back(p - text);
+   }
+}
+
 int Input::_pos_to_idx(Pos p) const {
+   if (_linepos.empty()) {
+      _index_lines();
+   }
+   p.lin -= _first_line - 1;
    if (p.lin < 1 || p.lin >= _linepos.size()) {
       return -1;
    }
@@ -230,21 +576,7 @@ int Input::_pos_to_idx(Pos p) const {
 }
 
 bool Input::peek(int offset) {
-   if (_in == 0 || !_in->good()) {
-      return false;
-   }
-   int k = _curr + offset;
-   if (k >= _text.size()) {
-      string line;
-      if (!getline(*_in, line)) {
-         return false;
-      }
-      _text += line;
-      if (!_in->eof()) {
-         _text += "\n";
-      }
-   }
-   return k < _text.size();
+   return _in != 0 and _curr + offset < _text.size();
 }
 
 bool Input::next() {
@@ -252,30 +584,18 @@ bool Input::next() {
       return false;
    }
    if (_curr == -1) {
-      _pos.lin = 1;
+      _pos.lin = _first_line;
       _pos.col = 0;
-      _linepos.push_back(0);
    } else if (_curr < _text.size() && _text[_curr] == '\n') {
       _pos.lin++;
       _pos.col = 0;
-      _linepos.push_back(_curr+1);
       _seen_endl = true;
    } else {
       _pos.col++;
    }
    _curr++;
    assert(_curr <= _text.size());
-   if (_curr == _text.size()) {
-      string line;
-      if (!getline(*_in, line)) {
-         return false;
-      }
-      _text += line;
-      if (!_in->eof()) {
-         _text += "\n";
-      }
-   }
-   return true;
+   return _curr < _text.size();
 }
 
 bool Input::expect(string word) {
@@ -296,80 +616,113 @@ bool Input::expect(string word) {
 
 void Input::read_singleline_comment(Comment& c) {
    consume("//");
-   while (!end() and curr() != '\n') {
-      c.text += curr();
-      next();
+   if (end()) {
+      return;
    }
+   const char *text = _text.data(), *endl;
+   endl = (const char *)memchr(text + _curr, '\n', _text.size() - _curr);
+   const int fin = (endl != 0 ? endl - text : _text.size());
+   c.text.append(text + _curr, fin - _curr);
+   _advance_to(fin);
    return;
 }
 
 void Input::read_multiline_comment(Comment& c) {
    consume("/*");
-   while (!end()) {
-      if (curr() == '*') {
-         peek(1);
-         if (curr(1) == '/') {
-            consume("*/");
-            return;
-         }
+   const char *text = _text.data(), *p = text + _curr, *end = text + _text.size();
+   while (p < end and (p = (const char *)memchr(p, '*', end - p)) != 0) {
+      if (p + 1 < end and p[1] == '/') {
+         c.text.append(text + _curr, p - (text + _curr));
+         _advance_to(p - text);
+         consume("*/");
+         return;
       }
-      c.text += curr();
-      next();
+      p++;
    }
+   c.text.append(text + _curr, _text.size() - _curr);
+   _advance_to(_text.size());
    error(pos().str() + "unfinished comment");
    return;
 }
 
-inline bool _isupper(char c) { return c >= 'A' and c <= 'Z'; }
-inline bool _islower(char c) { return c >= 'a' and c <= 'z'; }
-inline bool _isdigit(char c) { return c >= '0' and c <= '9'; }
+// Character classes, one table lookup per character
+enum { IdStart = 1, Digit = 2, IdChar = IdStart | Digit };
+
+struct CharClasses {
+   unsigned char cls[256];
+   CharClasses() {
+      for (int c = 0; c < 256; c++) {
+         cls[c] = 0;
+         if ((c >= 'A' and c <= 'Z') or (c >= 'a' and c <= 'z') or c == '_') {
+            cls[c] = IdStart;
+         } else if (c >= '0' and c <= '9') {
+            cls[c] = Digit;
+         }
+      }
+   }
+};
+static const CharClasses _classes;
+
+inline bool _is(char c, int cls) { 
+   return _classes.cls[(unsigned char)c] & cls; 
+}
+
+// Whether read_id would read just this token (a name or a keyword)
+bool Input::is_word(const Token& t) const {
+   if (t.ini < 0 or t.fin <= t.ini or !_is(_text[t.ini], IdStart)) {
+      return false;
+   }
+   for (int i = t.ini + 1; i < t.fin; i++) {
+      if (!_is(_text[i], IdChar)) {
+         return false;
+      }
+   }
+   return t.fin == _text.size() or !_is(_text[t.fin], IdChar);
+}
 
+// Identifiers have no newlines, so the cursor can jump to their end
 Token Input::read_id() {
    Token t;
    t.ini = _curr;
-   char c = curr();
-   if (!_isupper(c) and !_islower(c) and c != '_') {
+   if (_curr < 0 or !_is(curr(), IdStart)) {
       return Token();
    }
-   t.str += c;
-   next();
-   c = curr();
-   while (_isupper(c) or _islower(c) or _isdigit(c) or c == '_') {
-      t.str += c;
-      next();
-      c = curr();
+   int fin = _curr + 1;
+   while (fin < _text.size() and _is(_text[fin], IdChar)) {
+      fin++;
    }
+   _pos.col += fin - _curr;
+   _curr = fin;
    t.fin = _curr;
-   Token x = Token::token2type(substr(t));
+   Token x = Token::token2type(_text.data() + t.ini, t.fin - t.ini);
    t.kind  = x.kind;
    t.group = x.group;
    return t;
 }
 
 Token Input::read_operator() {
-   string op;
    char x;
-   int ini = _curr, fin = -1;
+   const int ini = _curr;
    switch (curr()) {
    case '+': case '&': case '|': // + ++ += & && &= | || |=
       x = curr();
-      op += x; next();
+      next();
       if (curr() == '=' or curr() == x) {
-         op += curr(); next();
+         next();
       }
       break;
 
    case '-':                     // - -- -= -> ->*
-      op += '-'; next();
+      next();
       switch (curr()) {
       case '=': case '-':
-         op += curr(); next();
+         next();
          break;
 
       case '>':
-         op += '>'; next();
+         next();
          if (curr() == '*') {
-            op += '*'; next();
+            next();
          }
          break;
       }
@@ -377,85 +730,62 @@ Token Input::read_operator() {
 
    case '*': case '/': case '%': // * *= / /= % %= = == ! != ^ ^=
    case '=': case '!': case '^': 
-      op += curr(); next();
+      next();
       if (curr() == '=') {
-         op += '='; next();
+         next();
       }
       break;
       
    case '<': case '>':           // < <= << <<= > >= >> >>=
       x = curr();
-      op += x; next();
+      next();
       if (curr() == x) {
-         op += x; next();
+         next();
       } 
       if (curr() == '=') {
-         op += '='; next();
+         next();
       }
       break;
 
    case ',': case '~': case '?': case ':': // , ~ ? :
-      op += curr(); next();
+      next();
       break;
 
    case 'o':
       if (curr(1) == 'r') {
          next(), next();
-         op = "or";
       }
       break;
 
    case 'a':
       if (curr(1) == 'n' and curr(2) == 'd') {
          next(), next(), next();
-         op = "and";
       }
       break;
       
    default:
       break;
    }
-   fin = _curr;
-   Token t(Token::token2type(op));
+   Token t(Token::token2type(_text.data() + ini, _curr - ini));
    t.ini = ini;
-   t.fin = fin;
-   t.str = op;
+   t.fin = _curr;
    return t;
 }
 
+// (the escape sequences are translated by 'str')
 Token Input::read_string_or_char_literal(char delim) {
-   string str;
    Token t;
-   t.ini = _curr+1;
    if (curr() == 'L') {
       next(); // TODO: Handle 'L'
    }
    consume(delim);
+   t.ini = _curr;
    while (curr() != delim) {
       if (curr() == '\\') {
          next();
-         switch (curr()) {
-         case 'a':  t.str += '\a'; break;
-         case 'b':  t.str += '\b'; break;
-         case 'f':  t.str += '\f'; break;
-         case 'n':  t.str += '\n'; break;
-         case 'r':  t.str += '\r'; break;
-         case 't':  t.str += '\t'; break;
-         case 'v':  t.str += '\v'; break;
-         case '\'': t.str += '\''; break;
-         case '\"': t.str += '\"'; break;
-         case '\?': t.str += '\?'; break;
-         case '\\': t.str += '\\'; break;
-         default: 
-            cerr << "warning: unknown escape sequence '\\" 
-                 << curr() << "'" << endl;
-            t.str += curr();
-         }
       } else if (curr() == '\n') {
          error(pos().str() + ": string inacabado");
          break;
-      } else {
-         t.str += curr();
       }
       next();
    }
@@ -472,19 +802,15 @@ Token Input::read_number_literal() {
    t.ini = _curr;
    if (curr() == '.') {
       next();
-      t.str += '.';
       return read_real_literal(t);
    } else if (curr() == '-') {
-      t.str += '-';
       next();
    }
-   while (isdigit(curr())) {
-      t.str += curr();
+   while (_is(curr(), Digit)) {
       next();
    }
    if (curr() == '.') {
       next();
-      t.str += '.';
       return read_real_literal(t);
    }
    t.fin = _curr;
@@ -493,8 +819,7 @@ Token Input::read_number_literal() {
 }
 
 Token Input::read_real_literal(Token t) {
-   while (isdigit(curr())) {
-      t.str += curr();
+   while (_is(curr(), Digit)) {
       next();
    }
    t.fin = _curr;
@@ -35,44 +35,78 @@ struct CommentSeq;
 
 class Input {
    std::istream* _in;
-   std::string _text;
+   std::string _text; // the whole input, read at once
    int _curr;
    Pos _pos;
-   std::vector<int> _linepos; // positions of line starts (ignoring position 0 since no line 0)
-
+   int _first_line; // of the text (a piece of a program starts further down)
+   int _piece;      // when > 0, the stream is read in pieces of about this size
+   std::string _next_line; // (of a stream read in pieces) the one that begins the next piece
+   mutable std::vector<int> _linepos; // positions of line starts (ignoring position 0 
+                                      // since no line 0), built when first needed
+
+   // A checkpoint is just the cursor (the line starts don't depend on 
+   // it), so lookahead costs the same anywhere in a big file
    struct SavedItem {
-      int              curr;
-      Pos              pos;
-      std::vector<int> linepos;
+      int curr;
+      Pos pos;
 
-      SavedItem(int c, Pos p, const std::vector<int>& l)
-         : curr(c), pos(p), linepos(l) {}
+      SavedItem(int c, Pos p) : curr(c), pos(p) {}
    };
    std::vector<SavedItem> _stack; // save/restore stack
 
+   // The tokens of the whole text, lexed once in advance. When the cursor
+   // is where one of them (or the spaces and comments before it) begins,
+   // peek_token, next_token and skip take it from here in O(1), so that 
+   // lookahead and backtracking don't lex the same text again. Anywhere
+   // else (inside a macro, after an error) the text is lexed as usual.
+   struct Lexeme {
+      Token       tok;
+      int         lead;     // where the spaces and comments before it begin
+      int         ini, fin; // of the token's text
+      Pos         pini, pfin;
+      CommentSeq *trivia;   // what skip("\n\t ") gives from 'lead'
+   };
+   std::vector<Lexeme> _lexemes;
+   std::vector<int>    _at;     // lexeme beginning at each offset (-1 = none)
+   bool                _lexing; // errors in _lex just stop it
+
    bool _seen_endl;
 
    void _reset() { 
-      _pos.lin = 1;
+      _pos.lin = _first_line;
       _pos.col = -1;
       _curr = -1; 
    }
 
-   int _pos_to_idx(Pos p) const;
+   void _read();
+   void _read_piece();
+   void _lex();
+   void _drop_lexemes();
+   void _advance_to(int idx);
+    int _lexeme_at(int offset) const { 
+      return (offset >= 0 and offset < _at.size() ? _at[offset] : -1);
+   }
+   bool _signed_literal(int k) const;
+   void _index_lines() const;
+    int _pos_to_idx(Pos p) const;
 
 public:
-                Input()                : _in(0), _linepos(1) { _reset(); }
-                Input(std::istream* i) : _in(i), _linepos(1) { _reset(); }
+                Input() : _in(0), _first_line(1), _piece(0), _lexing(false) { _reset(); }
+                Input(std::istream* i, int first_line = 1, int piece = 0);
+                Input(const Input&) = delete;
+               ~Input() { _drop_lexemes(); }
 
           bool  next();
           bool  peek(int offset);
           Pos   pos()           const { return _pos; }
           char  curr(int i = 0) const { return _text[_curr + i]; }
           bool  end()           const { return _curr >= _text.size(); }
+          bool  next_piece();
           bool  curr_one_of(std::string set) const;
    std::string  substr(const Range& r) const { return substr(r.ini, r.fin); }
    std::string  substr(const Pos& ini, const Pos& fin) const;
-   std::string  substr(const Token& t);
+   std::string  substr(const Token& t) const;
+   std::string  str(const Token& t) const;  // text (or value, for literals)
 
           void  save();
           void  restore();
@@ -88,7 +122,10 @@ public:
 
          Token  next_token();
          Token  peek_token();
+         Token  peek_token(int n);
+          bool  is_word(const Token& t) const;
          Token  peek_operator();
+         Token  next_operator();
          Token  read_id();
          Token  read_operator();
          Token  read_number_literal();
@@ -1,15 +1,18 @@
 #include "ast.hh"
 #include "translator.hh"
 #include "interpreter.hh"
+#include "annotator.hh"
 using namespace std;
 
-void Interpreter::_init() {}
+void Interpreter::_init() {
+   _break = false;
+}
 
-void Interpreter::setenv(string id, Value v, bool hidden) {
+void Interpreter::setenv(Symbol id, Value v, bool hidden) {
    _env.back().set(id, v, hidden);
 }
 
-bool Interpreter::getenv(string id, Value& v) {
+bool Interpreter::getenv(Symbol id, Value& v) {
    for (int i = _env.size()-1; i >= 0; i--) {
       if (_env[i].get(id, v)) {
          return true;
@@ -56,7 +59,7 @@ void Interpreter::invoke_func_prepare(FuncDecl *fn, const vector<Value>& args) {
       if (args[i].is<Reference>()) {
          Value v = args[i];
          if (!fn->params[i]->typespec->reference) {
-            v = Reference::deref(v);
+            v = Reference::deref(v).clone();
          }
          setenv(fn->params[i]->name, v);
       } else {
@@ -68,13 +71,6 @@ void Interpreter::invoke_func_prepare(FuncDecl *fn, const vector<Value>& args) {
    }
 }
 
-Value _max(const vector<Value>& args) {
-   assert(args.size() == 2);
-   assert(args[0].is<Int>());
-   assert(args[1].is<Int>());
-   return Value(std::max(args[0].as<Int>(), args[1].as<Int>()));
-}
-
 void Interpreter::prepare_global_environment() {
    _env.clear();
    _env.push_back(Environment("<global>"));
@@ -84,12 +80,14 @@ void Interpreter::prepare_global_environment() {
    setenv("cout", Cout, hidden);
    setenv("cin",  Cin,  hidden);
 
-   Function *max_func_type = new Function(Int::self);
-   max_func_type->add_params(Int::self, Int::self);
-   setenv("max",  max_func_type->mkvalue("max", new BuiltinFunc(_max)));
+   prepare_builtins();
+   prepare_algorithms();
+   _arena.clear();
 }
 
 void Interpreter::visit_program_prepare(Program *x) {
+   TypeAnnotator annotator;
+   x->accept(&annotator);
    prepare_global_environment();
    for (AstNode *n : x->nodes) {
       n->accept(this);
@@ -109,6 +107,7 @@ void Interpreter::visit_program(Program* x) {
    visit_program_prepare(x);
    visit_program_find_main();
    _curr.as<Function>().invoke(this, vector<Value>());
+   _arena.clear();
 }
 
 void Interpreter::visit_comment(CommentSeq* cn) {}
@@ -141,25 +140,32 @@ void Interpreter::visit_funcdecl(FuncDecl *x) {
 void Interpreter::visit_structdecl(StructDecl *x) {
    // Create a new Struct type now
    Struct *type = new Struct(x->struct_name());
+   Type::register_type(x->struct_name(), type); // (for fields 'T *next')
    for (int i = 0; i < x->decls.size(); i++) {
       DeclStmt& decl = *x->decls[i];
       Type *field_type = Type::get(decl.typespec);
       assert(type != 0);
       for (DeclStmt::Item& item : decl.items) {
          if (item.decl->is<ArrayDecl>()) {
-            Expr *size_expr = dynamic_cast<ArrayDecl*>(item.decl)->size;
-            Literal *size_lit = dynamic_cast<Literal*>(size_expr);
-            assert(size_lit != 0);
-            assert(size_lit->type == Literal::Int);
-            const int sz = size_lit->val.as_int;
-            // TODO: don't create new Array type every time?
-            type->add_field(item.decl->name, new Array(field_type, sz)); 
+            ArrayDecl *array = dynamic_cast<ArrayDecl*>(item.decl);
+            vector<int> dims;
+            for (int k = 0; k <= array->subsizes.size(); k++) {
+               Expr *size_expr = (k == 0 ? array->size : array->subsizes[k-1]);
+               Literal *size_lit = dynamic_cast<Literal*>(size_expr);
+               assert(size_lit != 0);
+               assert(size_lit->type == Literal::Int);
+               dims.push_back(size_lit->val.as_int);
+            }
+            type->add_field(item.decl->name, (dims.size() == 1 
+                                              ? (Type*)Array::mkarray(field_type, dims[0])
+                                              : (Type*)MultiArray::mkarray(field_type, dims)));
+         } else if (dynamic_cast<VarDecl*>(item.decl)->kind == Decl::Pointer) {
+            type->add_field(item.decl->name, Pointer::mkpointer(field_type));
          } else {
             type->add_field(item.decl->name, field_type);
          }
       }
    }
-   Type::register_type(x->struct_name(), type);
 }
 
 void Interpreter::visit_ident(Ident *x) {
@@ -183,32 +189,19 @@ void Interpreter::visit_literal(Literal *x) {
    }
 }
 
-struct _Add { template<typename T> static T eval(const T& a, const T& b) { return a + b; } };
-struct _Sub { template<typename T> static T eval(const T& a, const T& b) { return a - b; } };
-struct _Mul { template<typename T> static T eval(const T& a, const T& b) { return a * b; } };
-struct _Div { template<typename T> static T eval(const T& a, const T& b) { return a / b; } };
-
-struct _And { template<typename T> static T eval(const T& a, const T& b) { return a & b; } };
-struct _Or  { template<typename T> static T eval(const T& a, const T& b) { return a | b; } };
-struct _Xor { template<typename T> static T eval(const T& a, const T& b) { return a ^ b; } };
-
-struct _AAdd { template<typename T> static void eval(T& a, const T& b) { a += b; } };
-struct _ASub { template<typename T> static void eval(T& a, const T& b) { a -= b; } };
-struct _AMul { template<typename T> static void eval(T& a, const T& b) { a *= b; } };
-struct _ADiv { template<typename T> static void eval(T& a, const T& b) { a /= b; } };
-struct _AAnd { template<typename T> static void eval(T& a, const T& b) { a &= b; } };
-struct _AOr  { template<typename T> static void eval(T& a, const T& b) { a |= b; } };
-struct _AXor { template<typename T> static void eval(T& a, const T& b) { a ^= b; } };
-
-struct _Lt { template<typename T> static bool eval(const T& a, const T& b) { return a <  b; } };
-struct _Le { template<typename T> static bool eval(const T& a, const T& b) { return a <= b; } };
-struct _Gt { template<typename T> static bool eval(const T& a, const T& b) { return a >  b; } };
-struct _Ge { template<typename T> static bool eval(const T& a, const T& b) { return a >= b; } };
+// The value has the type the TypeAnnotator predicted for its expression
+inline bool pretyped(Expr *x, const Value& v) {
+   return x->static_type != 0 and x->static_type == v.type();
+}
 
+// Operands of the same type are not converted (which would copy them)
+inline Value convert_operand(const Value& left, const Value& right) {
+   return (left.same_type_as(right) ? right : left.type()->convert(right));
+}
 
 template<class Op>
 bool Interpreter::visit_op_assignment(Value left, Value _right) {
-   Value right = left.type()->convert(_right);
+   Value right = convert_operand(left, _right);
    if (left.is<Int>() and right.is<Int>()) {
       Op::eval(left.as<Int>(), right.as<Int>());
       return true;
@@ -226,7 +219,7 @@ bool Interpreter::visit_op_assignment(Value left, Value _right) {
 
 template<class Op>
 bool Interpreter::visit_bitop_assignment(Value left, Value _right) {
-   Value right = left.type()->convert(_right);
+   Value right = convert_operand(left, _right);
    if (left.is<Int>() and right.is<Int>()) {
       Op::eval(left.as<Int>(), right.as<Int>());
       return true;
@@ -282,7 +275,145 @@ bool Interpreter::visit_comparison(Value left, Value right) {
    return false;
 }
 
+// Specialized evaluators ///////////////////////////////////////////
+//
+// Once a node has seen the same operand types a few times, it is 
+// evaluated by one of these, which do not probe the types or compare 
+// the operator string again.
+
+enum SpecialOp {
+   sp_add, sp_sub, sp_mul, sp_div, sp_mod,
+   sp_lt, sp_le, sp_gt, sp_ge, sp_eq, sp_ne,
+   sp_bitand, sp_bitor, sp_bitxor, sp_and, sp_or,
+   sp_none = -1
+};
+
+SpecialOp special_op(string op) {
+   static const struct { const char *op; SpecialOp sop; } ops[] = {
+      { "+",   sp_add },    { "-",  sp_sub },    { "*",   sp_mul },
+      { "/",   sp_div },    { "%",  sp_mod },    { "<",   sp_lt  },
+      { "<=",  sp_le  },    { ">",  sp_gt  },    { ">=",  sp_ge  },
+      { "==",  sp_eq  },    { "!=", sp_ne  },    { "&",   sp_bitand },
+      { "|",   sp_bitor },  { "^",  sp_bitxor }, { "&&",  sp_and }, 
+      { "and", sp_and },    { "||", sp_or },     { "or",  sp_or  },
+   };
+   for (int i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+      if (op == ops[i].op) {
+         return ops[i].sop;
+      }
+   }
+   return sp_none;
+}
+
+// Which operators have a specialized evaluator for each type (the same
+// ones that the generic path accepts for two operands of that type)
+bool special_ok(SpecialOp op, const Type *t) {
+   if (t == Int::self) {
+      return op >= sp_add and op <= sp_bitxor;
+   } else if (t == Double::self or t == Float::self) {
+      return op >= sp_add and op <= sp_ne and op != sp_mod;
+   } else if (t == String::self) {
+      return op == sp_add or (op >= sp_lt and op <= sp_ne);
+   } else if (t == Bool::self) {
+      return op == sp_eq or op == sp_ne or op == sp_and or op == sp_or;
+   }
+   return false;
+}
+
+template<class T>
+Value special_cmp(int op, const typename T::cpp_type& a, const typename T::cpp_type& b) {
+   switch (op) {
+   case sp_lt: return Value(_Lt::eval(a, b));
+   case sp_le: return Value(_Le::eval(a, b));
+   case sp_gt: return Value(_Gt::eval(a, b));
+   case sp_ge: return Value(_Ge::eval(a, b));
+   case sp_eq: return Value(a == b);
+   case sp_ne: return Value(a != b);
+   }
+   assert(false);
+   return Value::null;
+}
+
+template<class T>
+Value special_num(int op, const typename T::cpp_type& a, const typename T::cpp_type& b) {
+   switch (op) {
+   case sp_add: return Value(_Add::eval(a, b));
+   case sp_sub: return Value(_Sub::eval(a, b));
+   case sp_mul: return Value(_Mul::eval(a, b));
+   case sp_div: return Value(_Div::eval(a, b));
+   }
+   return special_cmp<T>(op, a, b);
+}
+
+Value special_int(int op, int a, int b) {
+   switch (op) {
+   case sp_mod:    return Value(a % b);
+   case sp_bitand: return Value(_And::eval(a, b));
+   case sp_bitor:  return Value(_Or::eval(a, b));
+   case sp_bitxor: return Value(_Xor::eval(a, b));
+   }
+   return special_num<Int>(op, a, b);
+}
+
+Value special_bool(int op, bool a, bool b) {
+   switch (op) {
+   case sp_and: return Value(a and b);
+   case sp_or:  return Value(a or b);
+   case sp_eq:  return Value(a == b);
+   case sp_ne:  return Value(a != b);
+   }
+   assert(false);
+   return Value::null;
+}
+
+Value special_string(int op, const string& a, const string& b) {
+   if (op == sp_add) {
+      return Value(a + b);
+   }
+   return special_cmp<String>(op, a, b);
+}
+
+bool Interpreter::visit_binaryexpr_special(BinaryExpr *x, const Value& left, const Value& right) {
+   TypeFeedback& fb = x->feedback;
+   if (fb.state == TypeFeedback::Specialized) {
+      if (left.type() != fb.types[0] or right.type() != fb.types[1]) {
+         fb.generalize();
+         return false;
+      }
+      if (left.data() == 0 or right.data() == 0) {
+         return false; // (uninitialized, for the generic evaluator)
+      }
+      const Type *t = fb.types[0];
+      if (t == Int::self) {
+         _curr = special_int(fb.op, Int::cast(left.data()), Int::cast(right.data()));
+      } else if (t == Double::self) {
+         _curr = special_num<Double>(fb.op, Double::cast(left.data()), Double::cast(right.data()));
+      } else if (t == Float::self) {
+         _curr = special_num<Float>(fb.op, Float::cast(left.data()), Float::cast(right.data()));
+      } else if (t == Bool::self) {
+         _curr = special_bool(fb.op, Bool::cast(left.data()), Bool::cast(right.data()));
+      } else {
+         _curr = special_string(fb.op, String::cast(left.data()), String::cast(right.data()));
+      }
+      return true;
+   }
+   if (fb.seen(left.type(), right.type()) or
+       (pretyped(x->left, left) and pretyped(x->right, right))) {
+      SpecialOp op = (x->kind == Expr::Assignment ? sp_none : special_op(x->op));
+      if (left.type() == right.type() and special_ok(op, left.type()) and
+          left.data() != 0 and right.data() != 0) {
+         fb.specialize(op);
+      } else {
+         fb.generalize();
+      }
+   }
+   return false;
+}
+
 void Interpreter::visit_binaryexpr(BinaryExpr *x) {
+   if (x->inplace != BinaryExpr::NotInPlace and visit_binaryexpr_inplace(x)) {
+      return;
+   }
    x->left->accept(this);
    Value left = _curr;
    Value leftderef = Reference::deref(left);
@@ -310,7 +441,7 @@ void Interpreter::visit_binaryexpr(BinaryExpr *x) {
       if (!getenv(id->name, right)) {
          _error(_T("La variable '%s' no está declarada", id->name.c_str()));
       }
-      assert(leftderef.as<Istream>() == cin);
+      assert(&leftderef.as<Istream>() == &cin);
       right = Reference::deref(right);
       in() >> right;
       _curr = old;
@@ -320,10 +451,88 @@ void Interpreter::visit_binaryexpr(BinaryExpr *x) {
    x->right->accept(this);
    Value right = _curr;
    right = Reference::deref(right);
+   visit_binaryexpr_op(x, left, right);
+}
+
+// 's = s + x' appends to s (amortized, instead of copying s every
+// time), and 's[i] = c' stores into s. Returns false (having evaluated
+// only s, a variable) when s is not a string.
+bool Interpreter::visit_binaryexpr_inplace(BinaryExpr *x) {
+   if (x->inplace == BinaryExpr::Append) {
+      x->left->accept(this);
+      Value target = _curr;
+      Value s = Reference::deref(target);
+      if (!s.is<String>() or s.data() == 0) {
+         return false;
+      }
+      BinaryExpr *sum = static_cast<BinaryExpr*>(x->right);
+      sum->right->accept(this);
+      visit_string_append(sum, target, Reference::deref(_curr));
+      return true;
+   }
+   IndexExpr *cell = static_cast<IndexExpr*>(x->left);
+   cell->base->accept(this);
+   Value s = Reference::deref(_curr);
+   if (!s.is<String>() or s.data() == 0) {
+      return false;
+   }
+   cell->index->accept(this);
+   Value index = Reference::deref(_curr);
+   x->right->accept(this);
+   visit_string_store(s, index, Reference::deref(_curr));
+   return true;
+}
+
+void Interpreter::visit_string_append(BinaryExpr *sum, const Value& target, const Value& x) {
+   Value s = Reference::deref(target);
+   if (x.is<String>() and x.data() != 0) {
+      s.as<String>() += x.as<String>();
+   } else if (x.is<Char>() and x.data() != 0) {
+      s.as<String>() += x.as<Char>();
+   } else {
+      visit_binaryexpr_op(sum, s, x);
+      visit_binaryexpr_assignment(target, _curr);
+      return;
+   }
+   _curr = s;
+}
+
+void Interpreter::visit_string_store(const Value& s, const Value& index, const Value& c) {
+   if (!index.is<Int>()) {
+      _error(_T("El índice en un acceso a tabla debe ser un entero"));
+   }
+   string& str = s.as<String>();
+   const int i = index.as<Int>();
+   if (i < 0 || i >= str.size()) {
+      _error(_T("La casilla %d no existe", i));
+   }
+   if (c.is<Char>()) {
+      str[i] = c.as<Char>();
+   } else if (c.is<Int>()) {
+      str[i] = char(c.as<Int>());
+   } else {
+      _error(_T("La asignación no se puede hacer porque los "
+                "tipos no son compatibles (%s) vs (%s)", "char", 
+                (c.is_null() ? "?" : c.type_name().c_str())));
+   }
+   _curr = Value(str[i]);
+}
+
+void Interpreter::visit_binaryexpr_op(BinaryExpr *x, Value left, Value right) {
+   if (x->feedback.state != TypeFeedback::Generic and
+       visit_binaryexpr_special(x, left, right)) {
+      return;
+   }
    if (x->op == "=") {
       visit_binaryexpr_assignment(left, right);
       return;
    }
+   if ((left.is<Iterator>() or left.is<Array>()) and visit_iterator_op(x->op, left, right)) {
+      return;
+   }
+   if (left.is<Pointer>() and visit_pointer_op(x->op, left, right)) {
+      return;
+   }
    if (x->op == "+=" || x->op == "-=" || x->op == "*=" || x->op == "/=" ||
        x->op == "&=" || x->op == "|=" || x->op == "^=") {
       visit_binaryexpr_op_assignment(x->op[0], left, right);
@@ -348,6 +557,12 @@ void Interpreter::visit_binaryexpr(BinaryExpr *x) {
          if (left.is<String>() and right.is<String>()) {
             _curr = Value(left.as<String>() + right.as<String>());
             ret = true;
+         } else if (left.is<String>() and right.is<Char>()) {
+            _curr = Value(left.as<String>() + right.as<Char>());
+            ret = true;
+         } else if (left.is<Char>() and right.is<String>()) {
+            _curr = Value(left.as<Char>() + right.as<String>());
+            ret = true;
          } else {
             ret = visit_sumprod<_Add>(left, right);
          }
@@ -427,13 +642,17 @@ void Interpreter::visit_binaryexpr_assignment(Value left, Value right) {
       _error(_T("Intentas asignar sobre algo que no es una variable"));
    }
    left = Reference::deref(left);
-   right = left.type()->convert(right);
-   if (right == Value::null) {
+   Value converted = right;
+   if (!left.same_type_as(right) or left.is<Array>()) {
+      converted = left.type()->convert(right);
+   }
+   if (converted == Value::null) {
       _error(_T("La asignación no se puede hacer porque los "
                 "tipos no son compatibles (%s) vs (%s)", 
                 left.type_name().c_str(), 
-                right.type_name().c_str()));
+                (right.is_null() ? "?" : right.type_name().c_str())));
    }
+   right = converted;
    left.assign(right);
    _curr = left;
 }
@@ -449,6 +668,9 @@ void Interpreter::visit_binaryexpr_op_assignment(char op, Value left, Value righ
       if (left.is<String>() and right.is<String>()) {
          left.as<String>() += right.as<String>();
          ok = true;
+      } else if (left.is<String>() and right.is<Char>()) {
+         left.as<String>() += right.as<Char>();
+         ok = true;
       } else {
          ok = visit_op_assignment<_AAdd>(left, right);
       }
@@ -471,6 +693,9 @@ void Interpreter::visit_binaryexpr_op_assignment(char op, Value left, Value righ
 void Interpreter::visit_block(Block *x) {
    for (Stmt *stmt : x->stmts) {
       stmt->accept(this);
+      if (_break) {
+         return;
+      }
    }
 }
 
@@ -480,30 +705,47 @@ void Interpreter::visit_vardecl(VarDecl *x) {
    if (type == 0) {
       _error(_T("El tipo '%s' no existe.", type_name.c_str()));
    }
+   if (x->kind == Decl::Pointer) {
+      type = Pointer::mkpointer(type);
+   }
    _curr = Reference::deref(_curr);
+   Value init;
    try {
-      setenv(x->name, (_curr.is_null() ? type->create() : type->convert(_curr)));
+      init = (_curr.is_null() ? type->create() : type->convert(_curr));
    } catch (TypeError& e) {
       _error(e.msg);
    }
+   if (init.is_null() and !_curr.is_null()) {
+      _error(_T("La inicialización no se puede hacer porque los tipos no son compatibles"));
+   }
+   setenv(x->name, init);
 }
 
-void Interpreter::visit_arraydecl(ArrayDecl *x) {
-   Value init = _curr;
-   x->size->accept(this);
-   if (!_curr.is<Int>()) {
+int Interpreter::visit_arraysize(Value size) {
+   size = Reference::deref(size);
+   if (!size.is<Int>()) {
       _error(_T("El tamaño de una tabla debe ser un entero"));
    }
-   if (_curr.as<Int>() <= 0) {
+   if (size.as<Int>() <= 0) {
       _error(_T("El tamaño de una tabla debe ser un entero positivo"));
    }
-   const int sz = _curr.as<Int>();
+   return size.as<Int>();
+}
+
+void Interpreter::visit_arraydecl(ArrayDecl *x) {
+   Value init = _curr;
+   vector<int> dims;
+   for (int k = 0; k <= x->subsizes.size(); k++) {
+      (k == 0 ? x->size : x->subsizes[k-1])->accept(this);
+      dims.push_back(visit_arraysize(_curr));
+   }
    Type *celltype = Type::get(x->typespec);
    if (celltype == 0) {
       _error(_T("El tipo '%s' no existe", x->typespec->typestr().c_str()));
    }
-   // TODO: don't create new Array type every time?
-   Type *arraytype = new Array(celltype, sz);
+   Type *arraytype = (dims.size() == 1 
+                      ? (Type*)Array::mkarray(celltype, dims[0])
+                      : (Type*)MultiArray::mkarray(celltype, dims));
    setenv(x->name, (init.is_null() 
                     ? arraytype->create()
                     : arraytype->convert(init)));
@@ -518,7 +760,11 @@ void Interpreter::visit_objdecl(ObjDecl *x) {
          x->args[i]->accept(this);
          args.push_back(_curr);
       }
-      setenv(x->name, type->construct(args));
+      try {
+         setenv(x->name, type->construct(args));
+      } catch (TypeError& e) {
+         _error(e.msg);
+      }
       return;
    }
    _error(_T("The type '%s' is not implemented in MiniCC", 
@@ -537,18 +783,33 @@ void Interpreter::visit_declstmt(DeclStmt* x) {
 }
 
 void Interpreter::visit_exprstmt(ExprStmt* x) {
-   x->expr->accept(this);
-   if (x->is_return) {
+   if (x->expr == 0) {
+      return; // (after a parse error, or 'return;')
+   } else if (x->is_return) {
+      x->expr->accept(this);
       _ret = _curr;
+   } else {
+      visit_unused(x->expr);
+   }
+}
+
+// Evaluate an expression whose value is not used
+void Interpreter::visit_unused(Expr *x) {
+   if (x == 0) {
+      return;
+   } else if (x->is<IncrExpr>()) {
+      visit_increxpr_inplace(dynamic_cast<IncrExpr*>(x), false);
+   } else {
+      x->accept(this);
    }
 }
 
 void Interpreter::visit_ifstmt(IfStmt *x) {
    x->cond->accept(this);
-   if (!_curr.is<Bool>()) {
+   if (!pretyped(x->cond, _curr) and !_curr.is<Bool>()) {
       _error(_T("An if's condition needs to be a bool value"));
    }
-   if (_curr.as<Bool>()) {
+   if (Bool::cast(_curr.data())) {
       x->then->accept(this);
    } else {
       if (x->els != 0) {
@@ -558,31 +819,175 @@ void Interpreter::visit_ifstmt(IfStmt *x) {
 }
 
 void Interpreter::visit_iterstmt(IterStmt *x) {
+   if (x->counted != 0) {
+      visit_iterstmt_counted(x);
+      return;
+   }
    pushenv("");
    if (x->init) {
       x->init->accept(this);
    }
    while (true) {
       x->cond->accept(this);
-      if (!_curr.is<Bool>()) {
+      if (!pretyped(x->cond, _curr) and !_curr.is<Bool>()) {
          _error(_T("La condición de un '%s' debe ser un valor de tipo bool.",
                    (x->is_for() ? "for" : "while")));
       }
-      if (!_curr.as<Bool>()) {
+      if (!Bool::cast(_curr.data())) {
          break;
       }
       x->substmt->accept(this);
+      if (_break) {
+         _break = false;
+         break;
+      }
       if (x->post) {
-         x->post->accept(this);
+         visit_unused(x->post);
+      }
+   }
+   popenv();
+}
+
+// The induction variable is kept in the environment (the body uses it),
+// but the bound check and the step are done on its 'int' directly, as 
+// long as it stays an initialized 'int'.
+void Interpreter::visit_iterstmt_counted(IterStmt *x) {
+   const IterStmt::Counted& c = *x->counted;
+   BinaryExpr *cond = static_cast<BinaryExpr*>(x->cond);
+   pushenv("");
+   x->init->accept(this);
+   Value var;
+   getenv(c.var, var);
+   var = Reference::deref(var);
+   auto test = [&]() -> bool {
+      if (!_curr.is<Bool>()) {
+         _error(_T("La condición de un '%s' debe ser un valor de tipo bool.", "for"));
+      }
+      return _curr.as<Bool>();
+   };
+   Literal *limit = dynamic_cast<Literal*>(cond->right); // a constant bound
+   while (true) {
+      bool go;
+      if (var.type() == Int::self and var.data() != 0) {
+         Value bound;
+         if (limit == 0) {
+            cond->right->accept(this);
+            bound = Reference::deref(_curr);
+         }
+         if (limit != 0 or (bound.type() == Int::self and bound.data() != 0)) {
+            const int i = Int::cast(var.data());
+            const int n = (limit != 0 ? limit->val.as_int : Int::cast(bound.data()));
+            go = (c.cmp == IterStmt::Counted::Lt ? i <  n :
+                  c.cmp == IterStmt::Counted::Le ? i <= n : i != n);
+         } else {
+            visit_binaryexpr_op(cond, var, bound);
+            go = test();
+         }
+      } else {
+         x->cond->accept(this);
+         go = test();
+      }
+      if (!go) {
+         break;
+      }
+      x->substmt->accept(this);
+      if (_break) {
+         _break = false;
+         break;
+      }
+      if (var.type() == Int::self and var.data() != 0) {
+         Int::cast(var.data()) += c.step;
+      } else {
+         visit_unused(x->post);
       }
    }
    popenv();
 }
 
+int Interpreter::visit_switchstmt_value(Value v) {
+   v = Reference::deref(v);
+   if (v.is<Int>()) {
+      return v.as<Int>();
+   } else if (v.is<Char>()) {
+      return v.as<Char>();
+   } else if (v.is<Bool>()) {
+      return v.as<Bool>();
+   }
+   _error(_T("Un 'switch' sólo admite valores enteros o caracteres"));
+   return 0;
+}
+
+// The labels are evaluated once, the first time the switch runs
+SwitchStmt::Table *Interpreter::visit_switchstmt_table(SwitchStmt *x) {
+   SwitchStmt::Table *table = new SwitchStmt::Table();
+   table->deflt = -1;
+   vector<pair<int, int>>& sorted = table->sorted;
+   for (int k = 0; k < x->cases.size(); k++) {
+      if (x->cases[k].label == 0) {
+         table->deflt = k;
+         continue;
+      }
+      x->cases[k].label->accept(this);
+      sorted.push_back(make_pair(visit_switchstmt_value(_curr), k));
+   }
+   sort(sorted.begin(), sorted.end());
+   for (int i = 1; i < sorted.size(); i++) {
+      if (sorted[i].first == sorted[i-1].first) {
+         const int val = sorted[i].first;
+         delete table;
+         _error(_T("El valor %d aparece en dos 'case'", val));
+      }
+   }
+   if (!sorted.empty()) {
+      const long range = long(sorted.back().first) - sorted.front().first + 1;
+      if (range <= 2 * long(sorted.size()) + 8) { // dense enough
+         table->min = sorted.front().first;
+         table->jump.assign(range, -1);
+         for (auto& label : sorted) {
+            table->jump[label.first - table->min] = label.second;
+         }
+         sorted.clear();
+      }
+   }
+   return table;
+}
+
+void Interpreter::visit_switchstmt(SwitchStmt *x) {
+   x->cond->accept(this);
+   const int val = visit_switchstmt_value(_curr);
+   if (x->table == 0) {
+      x->table = visit_switchstmt_table(x);
+   }
+   const int first = x->table->find(val);
+   if (first < 0) {
+      return;
+   }
+   pushenv("");
+   for (int k = first; k < x->cases.size() and !_break; k++) {
+      for (Stmt *stmt : x->cases[k].stmts) {
+         stmt->accept(this);
+         if (_break) {
+            break;
+         }
+      }
+   }
+   _break = false;
+   popenv();
+}
+
+void Interpreter::visit_jumpstmt(JumpStmt *x) {
+   if (x->kind != JumpStmt::Break) {
+      string keyword[3] = { "break", "continue", "goto" };
+      _error(_T("El '%s' no está implementado en MiniCC", keyword[x->kind].c_str()));
+   }
+   _break = true;
+}
+
 void Interpreter::invoke_user_func(FuncDecl *decl, const vector<Value>& args) {
    pushenv(decl->funcname());
    invoke_func_prepare(decl, args);
    decl->block->accept(this);
+   _break = false;
    popenv();
 }
 
@@ -593,19 +998,22 @@ void Interpreter::visit_callexpr_getfunc(CallExpr *x) {
       _error(_T("Calling something other than a function."));
    }
 }
-void Interpreter::visit_callexpr(CallExpr *x) {
-   visit_callexpr_getfunc(x);
-   Value func = _curr;
-
+void Interpreter::visit_callexpr_args(CallExpr *x, const Function *func_type, 
+                                      vector<Value>& args) {
    // Eval arguments
-   vector<Value> args;
    for (int i = 0; i < x->args.size(); i++) {
       x->args[i]->accept(this);
       args.push_back(_curr);
    }
+   visit_callexpr_check(func_type, args);
+}
 
-   // Check types
-   const Function *func_type = func.type()->as<Function>();
+// (a nullptr argument becomes a null pointer of the parameter's type)
+void Interpreter::visit_callexpr_check(const Function *func_type, 
+                                       vector<Value>& args) {
+   if (func_type->is_variadic()) {
+      return;
+   }
    for (int i = 0; i < args.size(); i++) {
       string t1 = func_type->param(i)->typestr();
       Value arg_i = args[i];
@@ -615,11 +1023,38 @@ void Interpreter::visit_callexpr(CallExpr *x) {
          _error(_T("En el parámetro %d se requiere una variable.", i+1));
       }
       string t2 = arg_i.type()->typestr();
+      if (t1 != t2 and arg_i.has_type(Pointer::null) and func_type->param(i)->is<Pointer>()) {
+         args[i] = func_type->param(i)->create();
+         continue;
+      }
       if (t1 != t2) {
          _error(_T("El argumento %d no es compatible con el tipo del parámetro "
                    "(%s vs %s)", i+1, t1.c_str(), t2.c_str()));
       }
    }
+}
+
+void Interpreter::visit_callexpr(CallExpr *x) {
+   FieldExpr *fx = dynamic_cast<FieldExpr*>(x->func);
+   if (fx != 0) {
+      fx->base->accept(this);
+      Value obj = Reference::deref(_curr);
+      if (lookup_method(fx, obj)) {
+         visit_callexpr_method(x, fx, obj);
+         return;
+      }
+      visit_fieldexpr_obj(fx, obj);
+      _curr = Reference::deref(_curr);
+      if (!_curr.is<Function>()) {
+         _error(_T("Calling something other than a function."));
+      }
+   } else {
+      visit_callexpr_getfunc(x);
+   }
+   Value func = _curr;
+
+   vector<Value> args;
+   visit_callexpr_args(x, func.type()->as<Function>(), args);
    
    // Invoke
    func.as<Function>().invoke(this, args);
@@ -632,31 +1067,284 @@ void Interpreter::visit_callexpr(CallExpr *x) {
    _curr = _ret;
 }
 
+// Method calls go straight through the inline cache in the FieldExpr,
+// without creating a function value (and a BoundMethod) for every call.
+void Interpreter::visit_callexpr_method(CallExpr *x, FieldExpr *fx, Value obj) {
+   const Function *func_type = fx->cache.functype->as<Function>();
+   vector<Value> args;
+   visit_callexpr_args(x, func_type, args);
+   _ret = call_method(fx->cache.method, obj.data(), args);
+   if (_ret == Value::null && !func_type->is_void()) {
+      _error(_T("La función '%s' debería devolver un '%s'", 
+                fx->field->name.c_str(),
+                func_type->return_type()->typestr().c_str()));
+   }
+   _curr = _ret;
+}
+
 void Interpreter::visit_indexexpr(IndexExpr *x) {
+   if (x->chain > 1 and visit_indexexpr_chain(x)) {
+      return;
+   }
    x->base->accept(this);
-   _curr = Reference::deref(_curr);
-   if (!_curr.is<Array>() and !_curr.is<Vector>()) {
+   Value base = Reference::deref(_curr);
+   TypeFeedback& fb = x->feedback;
+   if (fb.state == TypeFeedback::Specialized) {
+      if (base.type() == fb.types[0]) {
+         x->index->accept(this);
+         Value index = Reference::deref(_curr);
+         vector<Value>& vals = *static_cast<vector<Value>*>(base.data());
+         if (index.type() == Int::self) {
+            visit_indexexpr_int(vals, Int::cast(index.data()));
+            return;
+         }
+         fb.generalize();
+         visit_indexexpr_cell(vals, index);
+         return;
+      }
+      fb.generalize();
+   }
+   if (base.is<Map>()) {
+      x->index->accept(this);
+      visit_indexexpr_key(base, Reference::deref(_curr));
+      return;
+   }
+   if (base.is<Adapter>()) {
+      x->index->accept(this);
+      visit_indexexpr_deque(base, Reference::deref(_curr));
+      return;
+   }
+   if (base.is<String>()) {
+      x->index->accept(this);
+      visit_indexexpr_char(base, Reference::deref(_curr));
+      return;
+   }
+   if (base.is<MultiArray>()) {
+      x->index->accept(this);
+      visit_indexexpr_row(base, Reference::deref(_curr));
+      return;
+   }
+   if (base.is<Pointer>()) {
+      x->index->accept(this);
+      visit_indexexpr_ptr(base, Reference::deref(_curr));
+      return;
+   }
+   if (!base.is<Array>() and !base.is<Vector>()) {
       _error(_T("Las expresiones de índice deben usarse sobre tablas o vectores"));
    }
-   vector<Value>& vals = (_curr.is<Array>() ? _curr.as<Array>() : _curr.as<Vector>());
+   vector<Value>& vals = (base.is<Array>() ? base.as<Array>() : base.as<Vector>());
    x->index->accept(this);
-   _curr = Reference::deref(_curr);
-   if (!_curr.is<Int>()) {
-      // FIXME: maps!
+   Value index = Reference::deref(_curr);
+   if (fb.state == TypeFeedback::Uninitialized and 
+       (fb.seen(base.type(), index.type()) or pretyped(x->index, index))) {
+      if (index.type() == Int::self) {
+         fb.specialize(0);
+      } else {
+         fb.generalize();
+      }
+   }
+   visit_indexexpr_cell(vals, index);
+}
+
+void Interpreter::visit_indexexpr_cell(vector<Value>& vals, const Value& index) {
+   if (!index.is<Int>()) {
       _error(_T("El índice en un acceso a tabla debe ser un entero"));
    }
-   const int i = _curr.as<Int>();
+   visit_indexexpr_int(vals, index.as<Int>());
+}
+
+void Interpreter::visit_indexexpr_int(vector<Value>& vals, int i) {
    if (i < 0 || i >= vals.size()) {
       _error(_T("La casilla %d no existe", i));
    }
    _curr = Reference::mkref(vals[i]);
 }
 
+// 'a[i]' on a table of more than one dimension is a row (sharing the cells)
+void Interpreter::visit_indexexpr_row(const Value& base, const Value& index) {
+   if (!index.is<Int>()) {
+      _error(_T("El índice en un acceso a tabla debe ser un entero"));
+   }
+   const MultiArray *type = base.type()->as<MultiArray>();
+   const int i = index.as<Int>();
+   if (i < 0 || i >= type->dim(0)) {
+      _error(_T("La casilla %d no existe", i));
+   }
+   _curr = type->row(base.data(), i);
+}
+
+// 'p[i]' is '*(p + i)'
+void Interpreter::visit_indexexpr_ptr(const Value& p, const Value& index) {
+   if (!index.is<Int>()) {
+      _error(_T("El índice en un acceso a tabla debe ser un entero"));
+   }
+   PtrValue q = p.as<Pointer>();
+   q.pos += index.as<Int>();
+   visit_derefexpr_pointer(q);
+}
+
+// 'a[i][j]...' all at once: on a table of as many dimensions, a single
+// cell at offset '(i * dim(1) + j) * dim(2) + ...'; on vectors (or tables)
+// of vectors, without the places in between. Returns false (having 
+// evaluated only the variable) for anything else.
+bool Interpreter::visit_indexexpr_chain(IndexExpr *x) {
+   const int n = x->chain;
+   Expr *indices[IndexExpr::MaxChain];
+   Expr *root = x;
+   for (int k = n - 1; k >= 0; k--) {
+      IndexExpr *cell = static_cast<IndexExpr*>(root);
+      indices[k] = cell->index;
+      root = cell->base;
+   }
+   root->accept(this);
+   Value base = Reference::deref(_curr);
+   if (base.is_null()) {
+      return false;
+   }
+   const MultiArray *multi = base.type()->as<MultiArray>();
+   if (multi != 0) {
+      if (multi->rank() != n) {
+         return false;
+      }
+      vector<Value>& cells = *static_cast<vector<Value>*>(base.data());
+      int offset = 0;
+      for (int k = 0; k < n; k++) {
+         indices[k]->accept(this);
+         Value index = Reference::deref(_curr);
+         if (index.type() != Int::self) {
+            _error(_T("El índice en un acceso a tabla debe ser un entero"));
+         }
+         const int i = Int::cast(index.data());
+         if (i < 0 || i >= multi->dim(k)) {
+            _error(_T("La casilla %d no existe", i));
+         }
+         offset = offset * multi->dim(k) + i;
+      }
+      _curr = Reference::mkref(cells[offset]);
+      return true;
+   }
+   const Type *t = base.type();
+   for (int k = 0; k < n; k++) {
+      if (t == 0) {
+         return false;
+      } else if (t->is<Vector>()) {
+         t = t->as<Vector>()->celltype();
+      } else if (t->is<Array>()) {
+         t = t->as<Array>()->celltype();
+      } else {
+         return false;
+      }
+   }
+   Value row = base;
+   for (int k = 0; k < n; k++) {
+      vector<Value>& vals = *static_cast<vector<Value>*>(row.data());
+      indices[k]->accept(this);
+      Value index = Reference::deref(_curr);
+      if (index.type() != Int::self) {
+         _error(_T("El índice en un acceso a tabla debe ser un entero"));
+      }
+      const int i = Int::cast(index.data());
+      if (i < 0 || i >= vals.size()) {
+         _error(_T("La casilla %d no existe", i));
+      }
+      if (k == n - 1) {
+         _curr = Reference::mkref(vals[i]);
+      } else {
+         row = vals[i];
+      }
+   }
+   return true;
+}
+
+// 'm[key]' inserts key (with the default value) if it is not there
+void Interpreter::visit_indexexpr_key(const Value& base, const Value& key) {
+   const Map *type = base.type()->as<Map>();
+   if (type->is_set()) {
+      _error(_T("Un '%s' no se puede indexar", type->typestr().c_str()));
+   }
+   if (key.type() != type->keytype()) {
+      _error(_T("El índice no es compatible con el tipo de las claves (%s vs %s)",
+                type->keytype()->typestr().c_str(), 
+                (key.is_null() ? "?" : key.type_name().c_str())));
+   }
+   if (key.data() == 0) {
+      _error(_T("El índice no está inicializado"));
+   }
+   _curr = Reference::mkref(type->index(base.data(), key));
+}
+
+// The chars of a string are not Values, so 's[i]' is a copy (see
+// visit_binaryexpr_inplace for 's[i] = c')
+void Interpreter::visit_indexexpr_char(const Value& s, const Value& index) {
+   if (!index.is<Int>()) {
+      _error(_T("El índice en un acceso a tabla debe ser un entero"));
+   }
+   if (s.data() == 0) {
+      _error(_T("El string no está inicializado"));
+   }
+   const string& str = s.as<String>();
+   const int i = index.as<Int>();
+   if (i < 0 || i >= str.size()) {
+      _error(_T("La casilla %d no existe", i));
+   }
+   _curr = Value(str[i]);
+}
+
+void Interpreter::visit_indexexpr_deque(const Value& base, const Value& index) {
+   if (base.type()->as<Adapter>()->kind() != Adapter::Deque) {
+      _error(_T("Un '%s' no se puede indexar", base.type_name().c_str()));
+   }
+   if (!index.is<Int>()) {
+      _error(_T("El índice en un acceso a tabla debe ser un entero"));
+   }
+   RingBuffer& ring = *static_cast<RingBuffer*>(base.data());
+   const int i = index.as<Int>();
+   if (i < 0 || i >= ring.size()) {
+      _error(_T("La casilla %d no existe", i));
+   }
+   _curr = Reference::mkref(ring[i]);
+}
+
+bool Interpreter::lookup_method(FieldExpr *x, const Value& obj) {
+   if (obj.is_null() or obj.is<Struct>()) {
+      return false;
+   }
+   FieldExpr::MethodCache& cache = x->cache;
+   if (cache.type != obj.type()) {
+      pair<Type *, Type::Method> method;
+      if (!obj.type()->get_method(x->field->name, method)) {
+         return false;
+      }
+      cache.type     = obj.type();
+      cache.functype = method.first;
+      cache.method   = method.second;
+   }
+   return true;
+}
+
+// Methods of emulated types report errors (an empty container, say) as
+// TypeErrors
+Value Interpreter::call_method(Type::Method method, void *data, const vector<Value>& args) {
+   try {
+      return (*method)(data, args);
+   } catch (TypeError& e) {
+      _error(e.msg);
+   }
+   return Value::null;
+}
+
 void Interpreter::visit_fieldexpr(FieldExpr *x) {
    x->base->accept(this);
-   _curr = Reference::deref(_curr);
-   if (_curr.is<Struct>()) {
-      SimpleTable<Value>& fields = _curr.as<Struct>();
+   visit_fieldexpr_obj(x, Reference::deref(_curr));
+}
+
+void Interpreter::visit_fieldexpr_obj(FieldExpr *x, Value obj) {
+   if (x->pointer and (obj.is<Pointer>() or obj.is<KeyIterator>())) {
+      visit_derefexpr_ptr(obj);
+      obj = Reference::deref(_curr);
+   }
+   if (obj.is<Struct>()) {
+      SimpleTable<Value>& fields = obj.as<Struct>();
       Value v;
       if (!fields.get(x->field->name, v)) {
          _error(_T("No existe el campo '%s'", x->field->name.c_str()));
@@ -664,10 +1352,9 @@ void Interpreter::visit_fieldexpr(FieldExpr *x) {
       _curr = Reference::mkref(v);
       return;
    }
-   pair<Type *, Type::Method> method;
-   if (_curr.type()->get_method(x->field->name, method)) {
-      Function *ft = dynamic_cast<Function*>(method.first);
-      _curr = ft->mkvalue(x->field->name, new BoundMethod(method.second, _curr.data()));
+   if (lookup_method(x, obj)) {
+      Function *ft = dynamic_cast<Function*>(x->cache.functype);
+      _curr = ft->mkvalue(x->field->name, new BoundMethod(x->cache.method, obj.data()));
       return;
    }
    _error(_T("Este objeto no tiene un campo '%s'", x->field->name.c_str()));
@@ -675,11 +1362,11 @@ void Interpreter::visit_fieldexpr(FieldExpr *x) {
 
 void Interpreter::visit_condexpr(CondExpr *x) {
    x->cond->accept(this);
-   if (!_curr.is<Bool>()) {
+   if (!pretyped(x->cond, _curr) and !_curr.is<Bool>()) {
       _error(_T("Una expresión condicional debe tener valor "
                 "de tipo 'bool' antes del interrogante"));
    }
-   if (_curr.as<Bool>()) {
+   if (Bool::cast(_curr.data())) {
       x->then->accept(this);
    } else {
       if (x->els != 0) {
@@ -717,23 +1404,232 @@ void Interpreter::visit_signexpr(SignExpr *x) {
 }
 
 void Interpreter::visit_increxpr(IncrExpr *x) {
+   visit_increxpr_inplace(x, !x->preincr);
+}
+
+// The variable is modified in place, and its old value is only copied if 
+// it is needed (a post-increment whose value is used).
+void Interpreter::visit_increxpr_inplace(IncrExpr *x, bool keep_old) {
    x->expr->accept(this);
    if (!_curr.is<Reference>()) {
       _error(_T("Hay que incrementar una variable, no un valor"));
    }
-   Value after  = Reference::deref(_curr);
-   Value before = after.clone();
-   if (after.is<Int>()) {
-      if (x->kind == IncrExpr::Positive) {
-         after.as<Int>()++;
-      } else {
-         after.as<Int>()--;
-      }
-   } else {
+   Value after = Reference::deref(_curr);
+   TypeFeedback& fb = x->feedback;
+   if (fb.state == TypeFeedback::Specialized and after.type() != Int::self) {
+      fb.generalize();
+   }
+   if (fb.state != TypeFeedback::Specialized and !after.is<Int>()) {
       _error(_T("Estás incrementando un valor de tipo '%s'", 
                 after.type_name().c_str()));
    }
-   _curr = (x->preincr ? before : after);
+   if (fb.state == TypeFeedback::Uninitialized and fb.seen(Int::self)) {
+      fb.specialize(0);
+   }
+   _curr = (keep_old ? after.clone() : after);
+   int& i = Int::cast(after.data());
+   if (x->kind == IncrExpr::Positive) {
+      i++;
+   } else {
+      i--;
+   }
+}
+
+void Interpreter::visit_derefexpr(DerefExpr *x) {
+   x->expr->accept(this);
+   visit_derefexpr_ptr(Reference::deref(_curr));
+}
+
+void Interpreter::visit_derefexpr_ptr(Value ptr) {
+   if (ptr.is<Pointer>()) {
+      visit_derefexpr_pointer(ptr.as<Pointer>());
+      return;
+   }
+   if (ptr.is<KeyIterator>()) {
+      visit_derefexpr_key(ptr.as<KeyIterator>());
+      return;
+   }
+   IterValue it;
+   if (!Iterator::get(ptr, it)) {
+      _error(_T("El operador '*' sólo se puede usar con iteradores"));
+   }
+   if (it.pos < 0 or it.pos >= it.cells->size()) {
+      _error(_T("El iterador no apunta a ninguna casilla"));
+   }
+   _curr = Reference::mkref((*it.cells)[it.pos]);
+}
+
+void Interpreter::visit_addrexpr(AddrExpr *x) {
+   x->expr->accept(this);
+   visit_addrexpr_place(_curr);
+}
+
+void Interpreter::visit_addrexpr_place(const Value& place) {
+   if (!place.is<Reference>()) {
+      _error(_T("Sólo se puede obtener la dirección de una variable"));
+   }
+   PtrValue p;
+   p.target = Reference::deref(place);
+   _curr = Pointer::mkpointer(p.target.type())->mkvalue(p);
+}
+
+// A block of the Arena is checked with its tag (if it was deleted, the
+// tag changed)
+void Interpreter::visit_derefexpr_pointer(const PtrValue& p) {
+   if (p.block < 0) {
+      if (p.target.is_null()) {
+         _error(_T("El puntero es nulo"));
+      }
+      if (p.pos != 0) {
+         _error(_T("El puntero apunta fuera de la variable"));
+      }
+      _curr = Reference::mkref(const_cast<Value&>(p.target));
+      return;
+   }
+   if (!_arena.live(p.block, p.tag)) {
+      _error(_T("El puntero apunta a memoria que ya se ha liberado"));
+   }
+   vector<Value>& cells = _arena.cells(p.block);
+   if (p.pos < 0 or p.pos >= cells.size()) {
+      _error(_T("El puntero apunta fuera de la memoria obtenida con 'new'"));
+   }
+   _curr = Reference::mkref(cells[p.pos]);
+}
+
+// 'p + k', 'p - k', 'p - q', 'p == q' and 'p != q' (against nullptr or 0 too)
+bool Interpreter::visit_pointer_op(string op, const Value& left, const Value& right) {
+   const PtrValue& p = left.as<Pointer>();
+   if ((op == "+" or op == "-") and right.is<Int>()) {
+      PtrValue q = p;
+      q.pos += (op == "+" ? right.as<Int>() : -right.as<Int>());
+      _curr = Pointer::mkpointer(left.type()->as<Pointer>()->pointee())->mkvalue(q);
+      return true;
+   }
+   if ((op == "==" or op == "!=") and right.is<Int>() and 
+       right.data() != 0 and right.as<Int>() == 0) { // 'p == 0'
+      _curr = Value(op == "==" ? p.is_null() : !p.is_null());
+      return true;
+   }
+   if (!right.is<Pointer>()) {
+      return false;
+   }
+   const PtrValue& q = right.as<Pointer>();
+   if (op == "-" and left.same_type_as(right) and p.block == q.block and p.tag == q.tag) {
+      _curr = Value(p.pos - q.pos);
+      return true;
+   }
+   if (op == "==" or op == "!=") {
+      _curr = Value(op == "==" ? p == q : !(p == q));
+      return true;
+   }
+   return false;
+}
+
+void Interpreter::visit_newexpr(NewExpr *x) {
+   Value size, init;
+   if (x->size) {
+      x->size->accept(this);
+      size = _curr;
+   }
+   if (x->init) {
+      x->init->accept(this);
+      init = Reference::deref(_curr);
+   }
+   visit_newexpr_block(x, size, init);
+}
+
+// 'new T[n]' gives a block of n cells, 'new T' a block of one
+void Interpreter::visit_newexpr_block(NewExpr *x, const Value& size, Value init) {
+   Type *type = Type::get(x->typespec);
+   if (type == 0) {
+      _error(_T("El tipo '%s' no existe.", x->typespec->typestr().c_str()));
+   }
+   const int ncells = (x->size ? visit_arraysize(size) : 1);
+   if (!init.is_null()) {
+      try {
+         init = type->convert(init);
+      } catch (TypeError& e) {
+         _error(e.msg);
+      }
+      if (init.is_null()) {
+         _error(_T("La inicialización no se puede hacer porque los tipos no son compatibles"));
+      }
+   }
+   PtrValue p;
+   p.block = _arena.alloc(ncells, x->size != 0);
+   p.tag   = _arena.tag(p.block);
+   vector<Value>& cells = _arena.cells(p.block);
+   for (int i = 0; i < ncells; i++) {
+      cells[i] = type->create();
+   }
+   if (!init.is_null()) {
+      cells[0] = init;
+   }
+   _curr = Pointer::mkpointer(type)->mkvalue(p);
+}
+
+void Interpreter::visit_deleteexpr(DeleteExpr *x) {
+   x->expr->accept(this);
+   visit_deleteexpr_ptr(x, Reference::deref(_curr));
+}
+
+void Interpreter::visit_deleteexpr_ptr(DeleteExpr *x, const Value& ptr) {
+   if (!ptr.is<Pointer>()) {
+      _error(_T("Sólo se puede usar 'delete' con punteros"));
+   }
+   const PtrValue& p = ptr.as<Pointer>();
+   _curr = Value::null;
+   if (p.is_null()) {
+      return; // 'delete nullptr' does nothing
+   }
+   if (p.block < 0 or p.pos != 0) {
+      _error(_T("Intentas liberar memoria que no se ha obtenido con 'new'"));
+   }
+   if (!_arena.live(p.block, p.tag)) {
+      _error(_T("Intentas liberar memoria que ya se ha liberado"));
+   }
+   if (_arena.array(p.block) != x->array) {
+      _error(x->array 
+             ? _T("Usa 'delete' (sin '[]') con la memoria obtenida con 'new'")
+             : _T("Usa 'delete[]' con la memoria obtenida con 'new[]'"));
+   }
+   _arena.release(p.block);
+}
+
+// The key for sets, a pair for maps (whose 'second' is the value in
+// the map, so it can be modified)
+void Interpreter::visit_derefexpr_key(const KeyIterValue& it) {
+   Value *val = (it.key.is_null() ? 0 : it.table->find(it.key));
+   if (val == 0) {
+      _error(_T("El iterador no apunta a ningún elemento"));
+   }
+   if (val->is_null()) {
+      _curr = it.key;
+      return;
+   }
+   Struct *type = Pair::mkpair(it.key.type(), val->type());
+   SimpleTable<Value> *fields = new SimpleTable<Value>();
+   fields->set("first", it.key.clone());
+   fields->set("second", *val);
+   _curr = Value(type, fields);
+}
+
+// 'it + k', 'it - k' and 'it2 - it1' (an array is an iterator to its 
+// first cell)
+bool Interpreter::visit_iterator_op(string op, const Value& left, const Value& right) {
+   IterValue it;
+   Iterator::get(left, it);
+   if ((op == "+" or op == "-") and right.is<Int>()) {
+      const int k = right.as<Int>();
+      _curr = Iterator::self->mkvalue(it.cells, it.pos + (op == "+" ? k : -k));
+      return true;
+   }
+   IterValue it2;
+   if (op == "-" and Iterator::get(right, it2) and it.cells == it2.cells) {
+      _curr = Value(it.pos - it2.pos);
+      return true;
+   }
+   return false;
 }
 
 void Interpreter::visit_negexpr(NegExpr *x) {
@@ -10,6 +10,34 @@
 #include "value.hh"
 #include "types.hh"
 
+// Operator functors (also instantiated by the ClosureCompiler)
+
+struct _Add { template<typename T> static T eval(const T& a, const T& b) { return a + b; } };
+struct _Sub { template<typename T> static T eval(const T& a, const T& b) { return a - b; } };
+struct _Mul { template<typename T> static T eval(const T& a, const T& b) { return a * b; } };
+struct _Div { template<typename T> static T eval(const T& a, const T& b) { return a / b; } };
+struct _Mod { template<typename T> static T eval(const T& a, const T& b) { return a % b; } };
+
+struct _And { template<typename T> static T eval(const T& a, const T& b) { return a & b; } };
+struct _Or  { template<typename T> static T eval(const T& a, const T& b) { return a | b; } };
+struct _Xor { template<typename T> static T eval(const T& a, const T& b) { return a ^ b; } };
+
+struct _AAdd { template<typename T> static void eval(T& a, const T& b) { a += b; } };
+struct _ASub { template<typename T> static void eval(T& a, const T& b) { a -= b; } };
+struct _AMul { template<typename T> static void eval(T& a, const T& b) { a *= b; } };
+struct _ADiv { template<typename T> static void eval(T& a, const T& b) { a /= b; } };
+struct _AAnd { template<typename T> static void eval(T& a, const T& b) { a &= b; } };
+struct _AOr  { template<typename T> static void eval(T& a, const T& b) { a |= b; } };
+struct _AXor { template<typename T> static void eval(T& a, const T& b) { a ^= b; } };
+struct _AMod { template<typename T> static void eval(T& a, const T& b) { a %= b; } };
+
+struct _Lt { template<typename T> static bool eval(const T& a, const T& b) { return a <  b; } };
+struct _Le { template<typename T> static bool eval(const T& a, const T& b) { return a <= b; } };
+struct _Gt { template<typename T> static bool eval(const T& a, const T& b) { return a >  b; } };
+struct _Ge { template<typename T> static bool eval(const T& a, const T& b) { return a >= b; } };
+struct _Eq { template<typename T> static bool eval(const T& a, const T& b) { return a == b; } };
+struct _Ne { template<typename T> static bool eval(const T& a, const T& b) { return a != b; } };
+
 struct EvalError {
    std::string msg;
    EvalError(std::string _msg) : msg(_msg) {}
@@ -18,13 +46,15 @@ struct EvalError {
 class Interpreter : public AstVisitor, public ReadWriter 
 {
                       Value _curr, _ret;
+                       bool _break; // a 'break' is leaving its loop or switch
    std::vector<Environment> _env;
+                      Arena _arena; // 'new' and 'delete'
 
      void  pushenv(std::string name) { _env.push_back(Environment(name));  }
      void  popenv();
      void  actenv();
-     void  setenv(std::string id, Value v, bool hidden = false);
-     bool  getenv(std::string id, Value& v);
+     void  setenv(Symbol id, Value v, bool hidden = false);
+     bool  getenv(Symbol id, Value& v);
 
     std::string 
            env2json() const;
@@ -36,14 +66,55 @@ class Interpreter : public AstVisitor, public ReadWriter
      Value new_value_from_structdecl(StructDecl *x);
 
      void  prepare_global_environment();
+     void  prepare_builtins();   // (builtins.cc)
+     void  prepare_algorithms(); // (algorithm.cc)
+
+   template<typename R, typename... Params>
+     void  bind(std::string name, R (*fn)(Params...)); // (builtins.hh)
      void  invoke_func_prepare(FuncDecl *x, const std::vector<Value>& args);
      void  invoke_user_func(FuncDecl *x, const std::vector<Value>&);
 
      void  visit_program_prepare(Program *x);
      void  visit_program_find_main();
+     bool  visit_binaryexpr_special(BinaryExpr *x, const Value& left, const Value& right);
+     void  visit_binaryexpr_op(BinaryExpr *x, Value left, Value right);
      void  visit_binaryexpr_assignment(Value left, Value right);
      void  visit_binaryexpr_op_assignment(char, Value left, Value right);
      void  visit_callexpr_getfunc(CallExpr *x);
+     void  visit_callexpr_args(CallExpr *x, const Function *func_type, 
+                               std::vector<Value>& args);
+     void  visit_callexpr_check(const Function *func_type, 
+                                std::vector<Value>& args);
+     void  visit_callexpr_method(CallExpr *x, FieldExpr *fx, Value obj);
+     void  visit_fieldexpr_obj(FieldExpr *x, Value obj);
+     void  visit_increxpr_inplace(IncrExpr *x, bool keep_old);
+     void  visit_unused(Expr *x);
+     void  visit_iterstmt_counted(IterStmt *x);
+      int  visit_switchstmt_value(Value v);
+SwitchStmt::Table 
+          *visit_switchstmt_table(SwitchStmt *x);
+     void  visit_derefexpr_ptr(Value ptr);
+     void  visit_derefexpr_pointer(const PtrValue& p);
+     bool  visit_pointer_op(std::string op, const Value& left, const Value& right);
+     void  visit_derefexpr_key(const KeyIterValue& it);
+     bool  visit_iterator_op(std::string op, const Value& left, const Value& right);
+     void  visit_indexexpr_cell(std::vector<Value>& vals, const Value& index);
+     void  visit_indexexpr_int(std::vector<Value>& vals, int i);
+     void  visit_indexexpr_key(const Value& base, const Value& key);
+     void  visit_indexexpr_deque(const Value& base, const Value& index);
+     void  visit_indexexpr_char(const Value& s, const Value& index);
+     void  visit_indexexpr_row(const Value& base, const Value& index);
+     void  visit_indexexpr_ptr(const Value& p, const Value& index);
+     bool  visit_indexexpr_chain(IndexExpr *x);
+      int  visit_arraysize(Value size);
+     void  visit_addrexpr_place(const Value& place);
+     void  visit_newexpr_block(NewExpr *x, const Value& size, Value init);
+     void  visit_deleteexpr_ptr(DeleteExpr *x, const Value& ptr);
+     bool  visit_binaryexpr_inplace(BinaryExpr *x);
+     void  visit_string_append(BinaryExpr *sum, const Value& target, const Value& x);
+     void  visit_string_store(const Value& s, const Value& index, const Value& c);
+     bool  lookup_method(FieldExpr *x, const Value& obj);
+    Value  call_method(Type::Method method, void *data, const std::vector<Value>& args);
 
    template<class Op>
      bool  visit_op_assignment(Value left, Value right);
@@ -61,6 +132,7 @@ class Interpreter : public AstVisitor, public ReadWriter
      bool  visit_comparison(Value left, Value right);
 
     friend class Stepper;
+    friend class ClosureCompiler;
 
    void _init();
 
@@ -88,6 +160,8 @@ public:
    void visit_exprstmt(ExprStmt *x);
    void visit_ifstmt(IfStmt *x);
    void visit_iterstmt(IterStmt *x);
+   void visit_switchstmt(SwitchStmt *x);
+   void visit_jumpstmt(JumpStmt *x);
    void visit_callexpr(CallExpr *x);
    void visit_indexexpr(IndexExpr *x);
    void visit_fieldexpr(FieldExpr *x);
@@ -96,11 +170,16 @@ public:
    void visit_signexpr(SignExpr *x);
    void visit_increxpr(IncrExpr *x);
    void visit_negexpr(NegExpr *x);
+   void visit_addrexpr(AddrExpr *x);
+   void visit_derefexpr(DerefExpr *x);
+   void visit_newexpr(NewExpr *x);
+   void visit_deleteexpr(DeleteExpr *x);
    void visit_literal(Literal *x);
 
    friend class UserFunc;
    friend class BuiltinFunc;
    friend class BoundMethod;
+   template<typename R, typename... Params> friend struct NativeFunc;
 };
 
 struct UserFunc : public FuncPtr {
@@ -125,7 +204,7 @@ struct BoundMethod : public FuncPtr {
    void *data;
    BoundMethod(Type::Method m, void *d) : method(m), data(d) {}
    void invoke(Interpreter* I, const std::vector<Value>& args) {
-      I->_ret = (*method)(data, args);
+      I->_ret = I->call_method(method, data, args);
    }
 };
 
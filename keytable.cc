@@ -0,0 +1,136 @@
+#include "keytable.hh"
+using namespace std;
+
+KeyTable *KeyTable::clone() const {
+   KeyTable *copy = empty();
+   each([copy](const Value& key, const Value& val) {
+      bool inserted;
+      copy->insert(key, inserted) = (val.is_null() ? val : val.clone());
+   });
+   return copy;
+}
+
+bool KeyTable::equals(KeyTable *t) const {
+   if (size() != t->size()) {
+      return false;
+   }
+   bool same = true;
+   each([t, &same](const Value& key, const Value& val) {
+      Value *other = (same ? t->find(key) : 0);
+      same = (other != 0 and (val.is_null() ? other->is_null() : val.equals(*other)));
+   });
+   return same;
+}
+
+// OrderedTable
+
+Value *OrderedTable::find(const Value& key) {
+   auto it = _map.find(key);
+   return (it == _map.end() ? 0 : &it->second);
+}
+
+Value& OrderedTable::insert(const Value& key, bool& inserted) {
+   auto it = _map.lower_bound(key);
+   inserted = (it == _map.end() or key.less(it->first));
+   if (inserted) {
+      it = _map.insert(it, make_pair(key.clone(), Value()));
+   }
+   return it->second;
+}
+
+void OrderedTable::each(Visitor visit) const {
+   for (auto& item : _map) {
+      visit(item.first, item.second);
+   }
+}
+
+// HashTable
+
+int HashTable::_lookup(const Value& key, size_t h) const {
+   if (_slots.empty()) {
+      return -1;
+   }
+   const size_t mask = _slots.size() - 1;
+   for (size_t i = h & mask; ; i = (i + 1) & mask) {
+      const Slot& s = _slots[i];
+      if (s.state == Slot::Free) {
+         return -1;
+      }
+      if (s.state == Slot::Full and s.hash == h and s.key.equals(key)) {
+         return i;
+      }
+   }
+}
+
+void HashTable::_rehash(int nslots) {
+   vector<Slot> old(nslots);
+   old.swap(_slots);
+   const size_t mask = _slots.size() - 1;
+   for (Slot& s : old) {
+      if (s.state == Slot::Full) {
+         size_t i = s.hash & mask;
+         while (_slots[i].state != Slot::Free) {
+            i = (i + 1) & mask;
+         }
+         _slots[i] = s;
+      }
+   }
+   _used = _size;
+}
+
+Value *HashTable::find(const Value& key) {
+   int i = _lookup(key, key.hash());
+   return (i < 0 ? 0 : &_slots[i].val);
+}
+
+Value& HashTable::insert(const Value& key, bool& inserted) {
+   const size_t h = key.hash();
+   int i = _lookup(key, h);
+   inserted = (i < 0);
+   if (!inserted) {
+      return _slots[i].val;
+   }
+   if (2 * (_used + 1) > _slots.size()) { // keep the load under 1/2
+      int n = 8;
+      while (n < 4 * (_size + 1)) {
+         n *= 2;
+      }
+      _rehash(n);
+   }
+   const size_t mask = _slots.size() - 1;
+   size_t k = h & mask;
+   while (_slots[k].state == Slot::Full) {
+      k = (k + 1) & mask;
+   }
+   Slot& s = _slots[k];
+   if (s.state == Slot::Free) {
+      _used++;
+   }
+   s.state = Slot::Full;
+   s.hash  = h;
+   s.key   = key.clone();
+   s.val   = Value();
+   _size++;
+   return s.val;
+}
+
+bool HashTable::erase(const Value& key) {
+   int i = _lookup(key, key.hash());
+   if (i < 0) {
+      return false;
+   }
+   Slot& s = _slots[i];
+   s.state = Slot::Erased;
+   s.key   = Value();
+   s.val   = Value();
+   _size--;
+   return true;
+}
+
+void HashTable::each(Visitor visit) const {
+   for (const Slot& s : _slots) {
+      if (s.state == Slot::Full) {
+         visit(s.key, s.val);
+      }
+   }
+}
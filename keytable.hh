@@ -0,0 +1,67 @@
+#ifndef KEYTABLE_HH
+#define KEYTABLE_HH
+
+#include <map>
+#include <vector>
+#include <functional>
+#include "value.hh"
+
+// The tables behind map, set, unordered_map and unordered_set. Keys are
+// owned by the table (they are cloned on insertion); sets keep a null
+// Value for every key.
+
+class KeyTable {
+public:
+   typedef std::function<void (const Value& key, const Value& val)> Visitor;
+
+   virtual ~KeyTable() {}
+   virtual       int  size()                    const = 0;
+   virtual     Value *find(const Value& key)          = 0; // 0 if not there
+   virtual     Value& insert(const Value& key, bool& inserted) = 0;
+   virtual      bool  erase(const Value& key)         = 0;
+   virtual  KeyTable *empty()                   const = 0; // a new table of the same kind
+   virtual      void  each(Visitor visit)       const = 0; // in order, for maps and sets
+
+   KeyTable *clone() const;
+   bool equals(KeyTable *t) const;
+};
+
+class OrderedTable : public KeyTable {
+   std::map<Value, Value, ValueLess> _map;
+public:
+         int  size()                    const { return _map.size(); }
+       Value *find(const Value& key);
+       Value& insert(const Value& key, bool& inserted);
+        bool  erase(const Value& key)         { return _map.erase(key) > 0; }
+    KeyTable *empty()                   const { return new OrderedTable(); }
+        void  each(Visitor visit)       const;
+};
+
+// Open addressing with linear probing over a power-of-two number of
+// slots; erased slots are left as tombstones until the next rehash.
+class HashTable : public KeyTable {
+   struct Slot {
+      enum State { Free, Full, Erased };
+      State  state;
+      size_t hash;
+      Value  key, val;
+      Slot() : state(Free), hash(0) {}
+   };
+   std::vector<Slot> _slots;
+   int _size, _used; // Full slots, and Full + Erased slots
+
+   int  _lookup(const Value& key, size_t h) const; // the Full slot with key, or -1
+   void _rehash(int nslots);
+
+public:
+   HashTable() : _size(0), _used(0) {}
+
+         int  size()                    const { return _size; }
+       Value *find(const Value& key);
+       Value& insert(const Value& key, bool& inserted);
+        bool  erase(const Value& key);
+    KeyTable *empty()                   const { return new HashTable(); }
+        void  each(Visitor visit)       const;
+};
+
+#endif
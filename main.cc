@@ -11,11 +11,47 @@ using namespace std;
 #include "flowcontrol.hh"
 #include "stepper.hh"
 #include "interpreter.hh"
+#include "closures.hh"
 #include "translator.hh"
 #include "walker.hh"
 
+// --stream: parse, print and check one top-level declaration at a time,
+// reading the file in pieces (for huge files)
+int stream(string todo, string filename) {
+   if (todo != "prettyprint" and todo != "flowcontrol") {
+      cerr << "--stream only works with --pprint and --flowcontrol" << endl;
+      return 1;
+   }
+   ifstream codefile(filename.c_str());
+   Parser P(&codefile, &cerr, 1, 1 << 16);
+   PrettyPrinter pr(&cout);
+   FlowControl fc(&cout);
+   AstVisitor *v = (todo == "prettyprint" ? (AstVisitor*)&pr : (AstVisitor*)&fc);
+   int nerrors = 0;
+   P.parse([&](Program *piece) {
+      vector<Error*> ve;
+      collect_errors(piece, ve);
+      for (Error *e : ve) {
+         cerr << _T("Compilation Error") << ": " << e->msg << endl;
+      }
+      piece->accept(v);
+      ve.clear();
+      collect_errors(piece, ve);
+      for (Error *e : ve) {
+         cerr << e->msg << endl;
+      }
+      nerrors += ve.size();
+   });
+   return (nerrors == 0 ? 0 : 1);
+}
+
 int main(int argc, char *argv[]) {
    string filename, todo = "eval", lang = "";
+   bool streaming = false;
+   if (argc > 1 and string(argv[1]) == "--stream") {
+      streaming = true;
+      argc--, argv++;
+   }
    if (argc > 1) {
       string argv1 = argv[1];
       if (argv1.substr(0, 7) == "--test-") {
@@ -41,6 +77,11 @@ int main(int argc, char *argv[]) {
             filename = argv[2];
          }
          todo = "step";
+      } else if (argv1 == "--closures") {
+         if (argc >= 3) {
+            filename = argv[2];
+         }
+         todo = "closures";
       } else if (argv1 == "--semantic") {
         if (argc >= 3) {
             filename = argv[2];
@@ -61,6 +102,9 @@ int main(int argc, char *argv[]) {
 
    Translator::translator.set_language("en");
 
+   if (streaming) {
+      return stream(todo, filename);
+   }
    ifstream codefile(filename.c_str());
    Parser P(&codefile);
    AstNode *program = P.parse();
@@ -82,6 +126,8 @@ int main(int argc, char *argv[]) {
             v = new TypeChecker(&cout);
          } else if (todo == "flowcontrol") {
             v = new FlowControl(&cout);
+         } else if (todo == "closures") {
+            v = new ClosureCompiler(&cin, &cout);
          } else {
             v = new Interpreter(&cin, &cout);
          }
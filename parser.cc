@@ -6,21 +6,20 @@ using namespace std;
 
 #include "parser.hh"
 #include "translator.hh"
+#include "walker.hh"
 
-Parser::Parser(istream *i, std::ostream* err) : _in(i), _err(err) {
+Parser::Parser(istream *i, std::ostream* err, int first_line, int piece)
+   : _in(i, first_line, piece), _err(err), _backtracks(0) {
    static const char *basic_types[] = {
       "int", "char", "string", "double", "float", "short", "long", "bool", "void",
-      "vector", "list", "map", "set", "pair"
+      "vector", "list", "map", "set", "pair", "unordered_map", "unordered_set",
+      "stack", "queue", "deque", "priority_queue", "less", "greater"
    };
    for (int i = 0; i < sizeof(basic_types) / sizeof(char*); i++) {
       _types.insert(basic_types[i]);
    }
 }
 
-bool Parser::_is_type(string s) {
-   return _types.find(s) != _types.end();
-}
-
 void Parser::error(AstNode *n, string msg) {
    Error *err = new Error(_in.pos(), msg);
    n->errors.push_back(err);
@@ -43,60 +42,117 @@ AstNode* Parser::parse() {
    }
    _skip(prog);
    while (!_in.end()) {
-      Pos pos = _in.pos();
-      Token tok = _in.peek_token();
-      switch (tok.kind) {
-      case Token::Sharp: {
-         prog->add(parse_macro());
-         break;
-      }
-      case Token::Using: {
-         prog->add(parse_using_declaration());
-         break;
-      }
-      case Token::Struct: {
-         StructDecl *decl = parse_struct();
-         _types.insert(decl->id->name);
-         prog->add(decl);
-         break;
-      }
-      case Token::Typedef: {
-         TypedefDecl *typdef = parse_typedef();
-         _types.insert(typdef->decl->name);
-         prog->add(typdef);
-         break;
+      AstNode *node = parse_toplevel(prog);
+      if (node != 0) {
+         prog->add(node);
       }
-      case Token::Enum: {
-         EnumDecl *enumdecl = parse_enum();
-         _types.insert(enumdecl->name);
-         prog->add(enumdecl);
-         break;
-      }
-      case Token::Class: {
-         prog->add(error<Stmt>(_T("UNIMPLEMENTED")));
-         _in.skip_to(";");
-         break;
+      _skip(prog);
+   }
+   return prog;
+}
+
+// One top-level declaration, or 0 when there is just an error (which goes
+// to 'prog')
+AstNode* Parser::parse_toplevel(Program *prog) {
+   Pos pos = _in.pos();
+   Token tok = _in.peek_token();
+   switch (tok.kind) {
+   case Token::Sharp:
+      return parse_macro();
+   case Token::Using:
+      return parse_using_declaration();
+   case Token::Struct: {
+      StructDecl *decl = parse_struct();
+      _types.insert(decl->id->name);
+      return decl;
+   }
+   case Token::Typedef: {
+      TypedefDecl *typdef = parse_typedef();
+      _types.insert(typdef->decl->name);
+      return typdef;
+   }
+   case Token::Enum: {
+      EnumDecl *enumdecl = parse_enum();
+      _types.insert(enumdecl->name);
+      return enumdecl;
+   }
+   case Token::Class: {
+      Stmt *err = error<Stmt>(_T("UNIMPLEMENTED"));
+      _in.skip_to(";");
+      return err;
+   }
+   case Token::Empty: {
+      ostringstream msg;
+      msg << pos << ": " << _T("Unexpected character '%c'", _in.curr());
+      Stmt *err = error<Stmt>(msg.str());
+      _in.next_token();
+      return err;
+   }
+   default:
+      if (tok.group & Token::Ident or 
+          tok.group & Token::TypeSpec) {
+         return parse_func_or_var();
       }
-      case Token::Empty: {
-         ostringstream msg;
-         msg << pos << ": " << _T("Unexpected character '%c'", _in.curr());
-         prog->add(error<Stmt>(msg.str()));
-         _in.next_token();
-         break;
+      error(prog, _T("Unexpected '%s' here.", _in.str(tok).c_str()));
+      _in.next_token();
+      return 0;
+   }
+}
+
+static CommentSeq *_join(CommentSeq *a, CommentSeq *b) {
+   if (a == 0) {
+      return b;
+   }
+   if (b != 0) {
+      a->items.insert(a->items.end(), b->items.begin(), b->items.end());
+      delete b;
+   }
+   return a;
+}
+
+// The comments after a declaration, reading the next pieces of the input
+// when they reach the end of one
+CommentSeq *Parser::_skip_pieces() {
+   CommentSeq *cs = _in.skip("\n\t ");
+   while (_in.end() and _in.next_piece()) {
+      cs = _join(cs, _in.skip("\n\t "));
+   }
+   return cs;
+}
+
+// The program is handed to 'each' in pieces, each with one top-level
+// declaration and the comments before it (the last one also has those at
+// the end), and deleted right after, so that only one declaration is in
+// memory at a time. (An input read in pieces also keeps only the text of
+// one piece.)
+void Parser::parse(function<void (Program*)> each) {
+   Program *prog = new Program();
+   if (!_in.next()) {
+      error(prog, _T("Error when reading input"));
+      each(prog);
+      delete_tree(prog);
+      return;
+   }
+   CommentSeq *before = _skip_pieces();
+   while (!_in.end()) {
+      AstNode *node = parse_toplevel(prog);
+      CommentSeq *after = _skip_pieces();
+      if (node == 0) { // the error goes with the next declaration
+         before = _join(before, after);
+         continue;
       }
-      default:
-         if (tok.group & Token::Ident or 
-             tok.group & Token::TypeSpec) {
-            prog->add(parse_func_or_var());
-            break;
-         }
-         error(prog, _T("Unexpected '%s' here.", tok.str.c_str()));
-         _in.next_token();
-         break;
+      prog->add(node);
+      prog->comments.push_back(before);
+      before = after;
+      if (!_in.end()) {
+         each(prog);
+         delete_tree(prog);
+         prog = new Program();
       }
-      _skip(prog);
    }
-   return prog;
+   prog->comments.push_back(before);
+   each(prog);
+   delete_tree(prog);
 }
 
 AstNode* Parser::parse_macro() {
@@ -106,7 +162,7 @@ AstNode* Parser::parse_macro() {
    Pos macro_ini = _in.pos();
    if (!_in.expect("include")) {
       Token tok = _in.read_id();
-      string macro_name = tok.str;
+      string macro_name = _in.str(tok);
       _in.skip_to("\n");
       Pos macro_fin = _in.pos();
       _in.next();
@@ -162,7 +218,7 @@ AstNode* Parser::parse_using_declaration() {
    }
    _skip(u);
    Token tok = _in.read_id();
-   u->namespc = tok.str;
+   u->namespc = _in.str(tok);
    _skip(u);
    u->fin = _in.pos();
    if (!_in.expect(";")) {
@@ -172,7 +228,7 @@ AstNode* Parser::parse_using_declaration() {
 }
 
 Ident *Parser::parse_ident(Token tok, Pos ini) {
-   Ident *id = new Ident(tok.str);
+   Ident *id = new Ident(_in.str(tok));
    Pos fin = _in.pos();
    while (true) {
       tok = _in.peek_token();
@@ -200,7 +256,7 @@ Ident *Parser::parse_ident(Token tok, Pos ini) {
       if (!(tok.group & Token::Ident)) {
          error(id, _T("Expected an identifier here"));
       }
-      id->shift(tok.str);
+      id->shift(_in.str(tok));
       fin = _in.pos();
    }
    id->ini = ini;
@@ -210,7 +266,7 @@ Ident *Parser::parse_ident(Token tok, Pos ini) {
 
 bool Parser::_parse_type_process_token(TypeSpec *type, Token tok, Pos p) {
    if (tok.group & Token::BasicType) {
-      Ident *id = new Ident(tok.str);
+      Ident *id = new Ident(_in.str(tok));
       if (type->id != 0) {
          error(type, _T("Basic types are not templates"));
       }
@@ -240,28 +296,100 @@ bool Parser::_parse_type_process_token(TypeSpec *type, Token tok, Pos p) {
    return false;
 }
 
+// Whether _parse_type_process_token would take 'tok'
+bool Parser::_continues_type(TypeSpec *type, Token tok) const {
+   return (tok.group & Token::BasicType) or (tok.group & Token::TypeQual) or
+          (type->id == 0 and (tok.group & Token::Ident)) or
+          tok.kind == Token::Amp;
+}
+
 TypeSpec *Parser::parse_typespec() {
    TypeSpec *type = new TypeSpec();
-   Pos p = _in.pos();
-   _in.save();
-   Token tok = _in.next_token();
-   while (_parse_type_process_token(type, tok, p)) {
-      _in.discard();
-      _in.save();
+   if (!_continues_type(type, _in.peek_token())) {
+      return type;
+   }
+   while (true) {
+      Pos p = _in.pos();
+      _parse_type_process_token(type, _in.next_token(), p);
+      if (!_continues_type(type, _in.peek_token())) {
+         break;
+      }
       _skip(type);
-      p = _in.pos(), tok = _in.next_token();
    }
-   _in.restore();
    return type;
 }
 
+// Lookahead (from the k-th token) over what parse_ident reads after
+// 'name': template arguments of a known type and "::" parts. Returns 
+// the index of the token after them, or sets *sure = false where the 
+// tokens are not simple enough to tell.
+int Parser::_skip_ident(int k, Symbol name, bool *sure) {
+   while (true) {
+      Token tok = _in.peek_token(k);
+      if (_is_type(name) and tok.kind == Token::LT) {
+         int depth = 0;
+         do {
+            switch (tok.kind) {
+            case Token::LT:     depth++;    break;
+            case Token::GT:     depth--;    break;
+            case Token::RShift: depth -= 2; break;
+            case Token::Comma: case Token::ColonColon: 
+            case Token::Star:  case Token::Amp:
+               break;
+            default:
+               if (!(tok.group & (Token::Ident | Token::BasicType | Token::TypeQual))) {
+                  *sure = false;
+                  return k;
+               }
+            }
+            tok = _in.peek_token(++k);
+         } while (depth > 0);
+         if (depth < 0) {
+            *sure = false;
+            return k;
+         }
+      }
+      if (tok.kind != Token::ColonColon) {
+         return k;
+      }
+      name = _in.str(_in.peek_token(++k));
+      k++;
+   }
+}
+
+// Whether a function follows the return type (parse_func_or_var) 
+bool Parser::_func_ahead(bool *sure) {
+   *sure = true;
+   int k = 0;
+   Token tok = _in.peek_token(k);
+   if (tok.kind == Token::Star) {
+      tok = _in.peek_token(++k);
+   }
+   Symbol name;
+   if (_in.is_word(tok)) { // what read_id would read
+      name = _in.str(tok);
+      k++;
+   }
+   k = _skip_ident(k, name, sure);
+   return *sure and _in.peek_token(k).kind == Token::LParen;
+}
 
 AstNode *Parser::parse_func_or_var() {
    CommentSeq *c[2] = { 0, 0 };
    Pos ini = _in.pos();
-   _in.save();
    TypeSpec *typespec = parse_typespec();
+   bool sure;
+   const bool is_func = _func_ahead(&sure);
+   if (sure and !is_func) {
+      return _parse_declstmt(ini, typespec, false);
+   }
+   _in.save();
    c[0] = _in.skip("\n\t ");
+   if (_in.curr() == '*') {
+      _in.consume("*");
+      typespec->pointer = true;
+      delete _in.skip("\n\t ");
+   }
    Pos id_ini = _in.pos();
    Token tok = _in.read_id();
    Ident *id = parse_ident(tok, id_ini);
@@ -275,9 +403,13 @@ AstNode *Parser::parse_func_or_var() {
       parse_function(fn);
       return fn;
    } else {
-      delete typespec;
-      _in.restore();
-      return parse_declstmt();
+      delete c[0];
+      delete c[1];
+      delete_tree(id);
+      typespec->pointer = false;
+      _in.restore(); // backtracking (to the end of the type)
+      _backtracks++;
+      return _parse_declstmt(ini, typespec, false);
    }
    return NULL;
 }
@@ -295,8 +427,13 @@ void Parser::parse_function(FuncDecl *fn) {
       ParamDecl *p = new ParamDecl();
       p->typespec = parse_typespec();
       _skip(fn);
+      if (_in.curr() == '*') {
+         _in.consume("*");
+         p->typespec->pointer = true;
+         _skip(fn);
+      }
       Token tok = _in.read_id();
-      p->name = tok.str;
+      p->name = _in.str(tok);
       _skip(fn);
       fn->params.push_back(p);
 
@@ -370,6 +507,9 @@ Stmt* Parser::parse_stmt() {
    case Token::Switch:
       return parse_switch();
 
+   case Token::Delete:
+      return parse_exprstmt();
+
    case Token::Return: {
       ExprStmt *stmt = parse_exprstmt(true);
       stmt->is_return = true;
@@ -383,11 +523,62 @@ Stmt* Parser::parse_stmt() {
    }
 }
 
+// Whether the statement ahead may be a declaration, following what
+// parse_declstmt reads: a type, maybe a '*', a name, and then '(', '[',
+// '=', ',' or ';'. When it isn't, parse_declstmt would surely fail.
+bool Parser::_decl_ahead() {
+   int k = 0;
+   bool has_id = false, sure = true;
+   Token tok = _in.peek_token(k);
+   while (true) {
+      if (tok.group & Token::BasicType) {
+         if (has_id) {
+            return true; // (an error, but let parse_declstmt report it)
+         }
+         has_id = true;
+         k++;
+      } else if (tok.group & Token::TypeQual) {
+         k++;
+      } else if (!has_id and (tok.group & Token::Ident)) {
+         has_id = true;
+         k = _skip_ident(k + 1, _in.str(tok), &sure);
+         if (!sure) {
+            return true;
+         }
+      } else if (tok.kind == Token::Amp) {
+         k++;
+      } else {
+         break;
+      }
+      tok = _in.peek_token(k);
+   }
+   if (tok.kind == Token::Star) {
+      tok = _in.peek_token(++k);
+   }
+   if (tok.group != Token::Ident) {
+      return false;
+   }
+   switch (_in.peek_token(k + 1).kind) {
+   case Token::LParen: case Token::LBrack: case Token::Comma: 
+   case Token::SemiColon: case Token::Assign: case Token::EqEq:
+      return true;
+   default:
+      return false;
+   }
+}
+
+// Only statements which look like declarations but aren't are parsed 
+// twice
 Stmt *Parser::parse_decl_or_expr_stmt() {
+   if (!_decl_ahead()) {
+      return parse_exprstmt();
+   }
    _in.save();
    DeclStmt *decl = parse_declstmt();
    if (decl->has_errors()) {
       _in.restore(); // backtracking
+      _backtracks++;
+      delete_tree(decl);
       return parse_exprstmt();
    } else {
       _in.discard();
@@ -409,12 +600,12 @@ Stmt *Parser::parse_jumpstmt() {
    _skip(stmt);
    if (stmt->kind == JumpStmt::Goto) {
       Token tok = _in.read_id();
-      stmt->label = tok.str;
+      stmt->label = _in.str(tok);
       _skip(stmt);
    }
    if (!_in.expect(";")) {
       error(stmt, _in.pos().str() + ": " 
-            + _T("Esperaba un ';' después de '%s'.", tok.str.c_str()));
+            + _T("Esperaba un ';' después de '%s'.", _in.str(tok).c_str()));
       _in.skip_to(";\n"); // resync...
    }
    return stmt;
@@ -483,7 +674,7 @@ Expr *Parser::parse_primary_expr() {
    }
    case Token::CharLiteral: {
       Literal* lit = new Literal(Literal::Char);
-      lit->val.as_string.s = new string(tok.str);
+      lit->val.as_string.s = &Symbol(_in.str(tok)).str();
       lit->ini = ini;
       lit->fin = _in.pos();
       _skip(lit);
@@ -493,7 +684,7 @@ Expr *Parser::parse_primary_expr() {
    case Token::Dot:
    case Token::RealLiteral: {
       Literal* lit = new Literal(Literal::Double);
-      istringstream S(tok.str);
+      istringstream S(_in.str(tok));
       S >> lit->val.as_double;
       lit->ini = ini;
       lit->fin = _in.pos();
@@ -503,7 +694,7 @@ Expr *Parser::parse_primary_expr() {
    }
    case Token::StringLiteral: {
       Literal* lit = new Literal(Literal::String);
-      lit->val.as_string.s = new string(tok.str);
+      lit->val.as_string.s = &Symbol(_in.str(tok)).str();
       lit->ini = ini;
       lit->fin = _in.pos();
       _skip(lit);
@@ -592,6 +783,27 @@ Expr *Parser::parse_unary_expr() {
       e = de;
       break;
    }      
+   case Token::New:
+      e = parse_newexpr();
+      break;
+   case Token::Delete: {
+      DeleteExpr *de = new DeleteExpr();
+      _in.consume("delete");
+      _skip(de);
+      if (_in.curr() == '[') {
+         _in.consume("[");
+         _skip(de);
+         if (!_in.expect("]")) {
+            error(de, _in.pos().str() + ": " + _T("Expected '%s' here.", "]"));
+         }
+         de->array = true;
+         _skip(de);
+      }
+      de->expr = parse_unary_expr();
+      de->fin = de->expr->fin;
+      e = de;
+      break;
+   }
    case Token::MinusMinus:
    case Token::PlusPlus: {
       IncrExpr *ie = new IncrExpr(tok.kind == Token::PlusPlus 
@@ -614,22 +826,54 @@ Expr *Parser::parse_unary_expr() {
    return e;
 }
 
-Expr *Parser::parse_expr(BinaryExpr::Kind max) {
-   CommentSeq *cn;
+// 'new T', 'new T(x)', 'new T{...}' and 'new T[n]'
+Expr *Parser::parse_newexpr() {
+   NewExpr *e = new NewExpr();
+   _in.consume("new");
+   _skip(e);
+   e->typespec = parse_typespec();
+   _skip(e);
+   if (_in.curr() == '[') {
+      _in.consume("[");
+      _skip(e);
+      e->size = parse_expr();
+      _skip(e);
+      if (!_in.expect("]")) {
+         error(e, _in.pos().str() + ": " + _T("Expected '%s' here.", "]"));
+      }
+   } else if (_in.curr() == '(') {
+      _in.consume("(");
+      _skip(e);
+      e->init = parse_expr(Expr::Assignment);
+      _skip(e);
+      if (!_in.expect(")")) {
+         error(e, _in.pos().str() + ": " + _T("Expected '%s' here.", ")"));
+      }
+   } else if (_in.curr() == '{') {
+      e->init = parse_exprlist();
+   }
+   e->fin = _in.pos();
+   _skip(e);
+   return e;
+}
 
+// Precedence climbing: each operator's Expr::Kind (Expr::tok2kind, a
+// table indexed by Token::Kind) is its binding power, and the lower it
+// is the tighter it binds. The loop takes every operator up to 'max',
+// and the right operand only those binding tighter (or as tight, if
+// right associative), so a chain like 'a + b + c + ...' is read in
+// this same loop, without deeper recursion.
+Expr *Parser::parse_expr(BinaryExpr::Kind max) {
    Expr *left = parse_unary_expr();
 
    while (true) {
       Token tok = _in.peek_operator();
-      if (!(tok.group & Token::Operator)) {
-         break;
-      }
       BinaryExpr::Kind kind = BinaryExpr::tok2kind(tok.kind);
-      if (tok.kind == Token::Empty or kind > max) {
+      if (kind == Expr::Unknown or kind > max) {
          break;
       }
       CommentSeq *c0 = _in.skip("\n\t ");
-      tok = _in.read_operator();
+      tok = _in.next_operator();
       if (tok.kind == Token::QMark) { // (... ? ... : ...)
          CondExpr *e = new CondExpr();
          e->cond = left;
@@ -707,7 +951,7 @@ Expr *Parser::parse_fieldexpr(Expr *x, Token tok) {
    _in.consume(tok.kind == Token::Arrow ? "->" : ".");
    _skip(e);
    Token id = _in.read_id();
-   e->field = new Ident(id.str);
+   e->field = new Ident(_in.str(id));
    e->fin = _in.pos();
    return e;
 }
@@ -784,24 +1028,78 @@ Stmt *Parser::parse_ifstmt() {
    }
    _skip(stmt);
    stmt->then = parse_stmt();
-   _in.save();
-   _skip(stmt);
-   string tok;
    if (_in.peek_token().kind == Token::Else) {
+      _skip(stmt);
       _in.consume("else");
-      _in.discard();
       _skip(stmt);
       stmt->els = parse_stmt();
-   } else {
-      stmt->comments.pop_back();
-      _in.restore();
    }
    stmt->fin = _in.pos();
    return stmt;
 }
 
 Stmt *Parser::parse_switch() {
-   return error<Stmt>(_T("UNIMPLEMENTED"));
+   SwitchStmt *stmt = new SwitchStmt();
+   stmt->ini = _in.pos();
+   _in.consume("switch");
+   _skip(stmt);
+   if (!_in.expect("(")) {
+      error(stmt, _in.pos().str() + ": " + _T("Expected '%s' here.", "("));
+   }
+   _skip(stmt);
+   stmt->cond = parse_expr();
+   _skip(stmt);
+   if (!_in.expect(")")) {
+      error(stmt, _in.pos().str() + ": " + _T("Expected '%s' here.", ")"));
+   }
+   _skip(stmt);
+   if (!_in.expect("{")) {
+      error(stmt, _in.pos().str() + ": " + _T("Expected '%s' here.", "{"));
+      stmt->fin = _in.pos();
+      return stmt;
+   }
+   _skip(stmt);
+   bool closing_curly = false, has_default = false;
+   while (!_in.end()) {
+      if (_in.curr() == '}') {
+         closing_curly = true;
+         _in.next();
+         break;
+      }
+      Token tok = _in.peek_token();
+      if (tok.kind == Token::Case or tok.kind == Token::Default) {
+         SwitchStmt::Case c;
+         Pos pos = _in.pos();
+         _in.next_token();
+         _skip(stmt);
+         if (tok.kind == Token::Case) {
+            c.label = parse_expr(Expr::Conditional);
+            _skip(stmt);
+         } else if (has_default) {
+            error(stmt, pos.str() + ": " + _T("There are two 'default' in the same 'switch'."));
+         }
+         has_default = has_default or tok.kind == Token::Default;
+         if (!_in.expect(":")) {
+            error(stmt, _in.pos().str() + ": " + _T("Expected '%s' here.", ":"));
+            _in.skip_to(":\n"); // resync...
+            _in.expect(":");
+         }
+         stmt->cases.push_back(c);
+      } else {
+         Stmt *s = parse_stmt();
+         if (stmt->cases.empty()) {
+            error(stmt, s->ini.str() + ": " + _T("Expected 'case' or 'default' here."));
+            stmt->cases.push_back(SwitchStmt::Case()); // (not to lose it)
+         }
+         stmt->cases.back().stmts.push_back(s);
+      }
+      _skip(stmt);
+   }
+   if (!closing_curly) {
+      error(stmt, _T("Expected '}' but end of text found"));
+   }
+   stmt->fin = _in.pos();
+   return stmt;
 }
 
 void Parser::parse_expr_seq(AstNode *n, vector<Expr*>& exprs) {
@@ -865,6 +1163,15 @@ Decl *Parser::_parse_arraydecl(string name, Decl::Kind kind, CommentSeq *comm) {
       error(decl, _in.pos().str() + ": " + _T("Expected '%s' here.", "]"));
    }
    _skip(decl);
+   while (_in.curr() == '[') {
+      _in.consume("[");
+      _skip(decl);
+      decl->subsizes.push_back(parse_expr(Expr::Conditional));
+      if (!_in.expect("]")) {
+         error(decl, _in.pos().str() + ": " + _T("Expected '%s' here.", "]"));
+      }
+      _skip(decl);
+   }
    return decl;
 }
 
@@ -883,20 +1190,26 @@ Decl *Parser::_parse_objdecl(string name, CommentSeq *comm) {
 }
 
 DeclStmt *Parser::parse_declstmt(bool is_typedef) {
-   DeclStmt *stmt = new DeclStmt();
-   stmt->ini = _in.pos();
+   Pos ini = _in.pos();
    TypeSpec *typespec = parse_typespec();
+   return _parse_declstmt(ini, typespec, is_typedef);
+}
+
+// The rest of a declaration, once its type is read
+DeclStmt *Parser::_parse_declstmt(Pos ini, TypeSpec *typespec, bool is_typedef) {
+   DeclStmt *stmt = new DeclStmt();
+   stmt->ini = ini;
    _skip(stmt); // before identifier
    stmt->typespec = typespec;
    while (true) {
       Token id = _in.next_token();
-      string name = id.str;
+      string name = _in.str(id);
       Decl::Kind kind = Decl::Normal;
       if (id.kind == Token::Star) {
          kind = Decl::Pointer;
          _skip(stmt);
          id = _in.next_token();
-         name = id.str;
+         name = _in.str(id);
       }
       if (id.group != Token::Ident) {
          error(stmt, _T("Expected an identifier here."));
@@ -942,7 +1255,7 @@ EnumDecl *Parser::parse_enum() {
       _in.skip_to(";");
       return decl;
    }
-   decl->name = tok.str;
+   decl->name = _in.str(tok);
    _skip(decl);
    if (!_in.expect("{")) {
       error(decl, _in.pos().str() + ": " + _T("Expected '%s' here.", "{"));
@@ -956,7 +1269,7 @@ EnumDecl *Parser::parse_enum() {
          _in.skip_to(",}");
          break;
       }
-      EnumDecl::Value v(tok.str);
+      EnumDecl::Value v(_in.str(tok));
       _skip(decl);
       if (_in.curr() == '=') {
          _in.next();
@@ -967,7 +1280,7 @@ EnumDecl *Parser::parse_enum() {
             _in.skip_to(",};");
          }
          v.has_val = true;
-         istringstream S(num.str);
+         istringstream S(_in.str(num));
          S >> v.val;
          _skip(decl);
       }
@@ -1008,7 +1321,7 @@ StructDecl *Parser::parse_struct() {
    StructDecl *decl = new StructDecl();
    _skip(decl);
 
-   decl->id = new Ident(_in.read_id().str);
+   decl->id = new Ident(_in.str(_in.read_id()));
    _skip(decl);
    
    tok = _in.next_token();
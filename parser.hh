@@ -2,6 +2,8 @@
 #define PARSER_H
 
 #include <set>
+#include <unordered_set>
+#include <functional>
 #include "ast.hh"
 #include "input.hh"
 
@@ -11,8 +13,10 @@ class Parser {
    Input _in;
    std::ostream *_err;
 
-   set<std::string> _types; // things known as types
-   bool _is_type(std::string);
+   std::unordered_set<Symbol> _types; // things known as types
+   bool _is_type(Symbol name) const { return _types.count(name) > 0; }
+
+   int _backtracks; // statements parsed twice (a declaration, then an expression)
 
    void _skip(string stopset) {
       CommentSeq *cn = _in.skip(stopset);
@@ -24,6 +28,8 @@ class Parser {
       n->comments.push_back(_in.skip(stopset));
    }
    
+   CommentSeq *_skip_pieces();
+
    void error(AstNode *n, std::string msg);
 
    template<class Node>
@@ -32,17 +38,27 @@ class Parser {
    void parse_expr_seq(AstNode *n, std::vector<Expr*>& v);
    void parse_type_seq(AstNode *n, std::vector<TypeSpec*>& v);
    bool _parse_type_process_token(TypeSpec *type, Token tok, Pos p);
+   bool _continues_type(TypeSpec *type, Token tok) const;
+    int _skip_ident(int k, Symbol name, bool *sure);
+   bool _func_ahead(bool *sure);
+   bool _decl_ahead();
+   DeclStmt *_parse_declstmt(Pos ini, TypeSpec *typespec, bool is_typedef);
 
    Decl *_parse_vardecl(std::string name, Decl::Kind kind, CommentSeq *comm);
    Decl *_parse_arraydecl(std::string name, Decl::Kind kind, CommentSeq *comm);
    Decl *_parse_objdecl(std::string name, CommentSeq *comm);
 
 public:
-             Parser(std::istream *in, std::ostream* err = &std::cerr);
+             Parser(std::istream *in, std::ostream* err = &std::cerr,
+                    int first_line = 1, int piece = 0);
 
 const Input& input() const { return _in; }
+       void  declare_type(std::string name) { _types.insert(name); }
+        int  backtracks() const { return _backtracks; }
 
     AstNode *parse();
+       void  parse(std::function<void (Program*)> each);
+    AstNode *parse_toplevel(Program *prog);
     AstNode *parse_macro();
     AstNode *parse_using_declaration();
     AstNode *parse_func_or_var();
@@ -74,6 +90,7 @@ TypedefDecl *parse_typedef();
        Expr *parse_indexexpr(Expr *);
        Expr *parse_fieldexpr(Expr *, Token);
        Expr *parse_increxpr(Expr *, Token);
+       Expr *parse_newexpr();
        Expr *parse_exprlist();
 };
 
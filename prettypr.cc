@@ -84,23 +84,32 @@ string CommentPrinter::CMT(bool pre, bool post, bool _endl, bool missing) {
 
 // Pretty Printer //////////////////////////////////////////////////
 
+// A program may also come in pieces (see Parser::parse(each)), with the
+// comments before each declaration, and a last one with those at the end
 void PrettyPrinter::visit_program(Program* x) {
    CommentPrinter cp(x, this);
-   int i;
-   for (i = 0; i < x->nodes.size(); i++) {
+   for (int i = 0; i < x->nodes.size(); i++, _toplevel++) {
+      CommentSeq *c = cp.next();
+      if (_toplevel > 0 and c and !c->starts_with_endl()) {
+         out() << ' ';
+      }
       out() << cp.cmt();
       AstNode *n = x->nodes[i];
       if ((!cp.last_was_empty() and !cp.last_had_endl()) or
-          (i > 0 and n->is<FuncDecl>() and 
-           (x->comments[i] and !x->comments[i]->ends_with_empty_line()))) {
+          (_toplevel > 0 and n->is<FuncDecl>() and 
+           (c and !c->ends_with_empty_line()))) {
          out() << endl;
       }
       n->accept(this);
-      if (cp.next() and !cp.next()->starts_with_endl()) {
-         out() << ' ';
-      }
+   }
+   if (!x->comments.empty() and 
+       x->comments.size() <= x->nodes.size()) { // more pieces to come
+      return;
    }
    CommentSeq *last = cp.next();
+   if (_toplevel > 0 and last and !last->starts_with_endl()) {
+      out() << ' ';
+   }
    if (last) {
       last->only_one_endl_at_end();
    }
@@ -108,6 +117,7 @@ void PrettyPrinter::visit_program(Program* x) {
    if (last == 0 or !last->has_endl()) {
       out() << endl;
    }
+   _toplevel = 0;
 }
 
 void PrettyPrinter::visit_include(Include* x) {
@@ -199,7 +209,7 @@ void PrettyPrinter::visit_structdecl(StructDecl *x) {
 void PrettyPrinter::visit_funcdecl(FuncDecl *x) {
    CommentPrinter cp(x, this);
    visit_typespec(x->return_typespec);
-   out() << " " << cp.cmt_();
+   out() << (x->return_typespec->pointer ? " *" : " ") << cp.cmt_();
    x->id->accept(this);
    out() << cp._cmt_();
    if (x->params.empty()) {
@@ -212,7 +222,7 @@ void PrettyPrinter::visit_funcdecl(FuncDecl *x) {
          }
          out() << cp.cmt_();
          visit_typespec(x->params[i]->typespec);
-         out() << " " << cp.cmt_();
+         out() << (x->params[i]->typespec->pointer ? " *" : " ") << cp.cmt_();
          out() << x->params[i]->name;
          out() << cp._cmt();
       }
@@ -339,6 +349,11 @@ void PrettyPrinter::visit_arraydecl(ArrayDecl *x) {
    out() << "[" << cp.cmt_();
    x->size->accept(this);
    out() << "]" << cp._cmt();
+   for (Expr *size : x->subsizes) {
+      out() << "[";
+      size->accept(this);
+      out() << "]";
+   }
 }
 
 void PrettyPrinter::visit_objdecl(ObjDecl *x) {
@@ -428,6 +443,30 @@ void PrettyPrinter::visit_iterstmt(IterStmt *x) {
    x->substmt->accept(this);
 }
 
+void PrettyPrinter::visit_switchstmt(SwitchStmt *x) {
+   CommentPrinter cp(x, this);
+   out() << "switch " << cp.cmt_() << "(" << cp.cmt_();
+   x->cond->accept(this);
+   out() << cp._cmt() << ") " << cp.cmt_() << "{";
+   for (SwitchStmt::Case& c : x->cases) {
+      out() << cp._cmtl();
+      if (c.label) {
+         out() << "case " << cp.cmt_();
+         c.label->accept(this);
+      } else {
+         out() << "default";
+      }
+      out() << cp._cmt() << ":";
+      indent(+1);
+      for (Stmt *s : c.stmts) {
+         out() << cp._cmtl();
+         s->accept(this);
+      }
+      indent(-1);
+   }
+   out() << cp._cmtl() << "}";
+}
+
 void PrettyPrinter::visit_jumpstmt(JumpStmt *x) {
    CommentPrinter cp(x, this);
    string keyword[3] = { "break", "continue", "goto" };
@@ -567,6 +606,41 @@ void PrettyPrinter::visit_derefexpr(DerefExpr *x) {
    }
 }
 
+void PrettyPrinter::visit_newexpr(NewExpr *x) {
+   CommentPrinter cp(x, this);
+   if (x->paren) {
+      out() << "(";
+   }
+   out() << "new " << cp.cmt_();
+   visit_typespec(x->typespec);
+   if (x->size) {
+      out() << "[";
+      x->size->accept(this);
+      out() << "]";
+   } else if (x->init and x->init->is<ExprList>()) {
+      x->init->accept(this);
+   } else if (x->init) {
+      out() << "(";
+      x->init->accept(this);
+      out() << ")";
+   }
+   if (x->paren) {
+      out() << ")";
+   }
+}
+
+void PrettyPrinter::visit_deleteexpr(DeleteExpr *x) {
+   CommentPrinter cp(x, this);
+   if (x->paren) {
+      out() << "(";
+   }
+   out() << "delete" << (x->array ? "[] " : " ") << cp.cmt_();
+   x->expr->accept(this);
+   if (x->paren) {
+      out() << ")";
+   }
+}
+
 void PrettyPrinter::visit_errorstmt(Stmt::Error *x) {
    out() << "/* ErrorStmt: \"" << x->code << "\" */";
 }
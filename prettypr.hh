@@ -7,10 +7,11 @@
 
 class PrettyPrinter : public AstVisitor, public ReadWriter {
    void print_block(Block *);
+   int _toplevel; // top-level declarations printed
 
 public:
    PrettyPrinter(std::ostream *o = &std::cout) 
-      : ReadWriter(o) {}
+      : ReadWriter(o), _toplevel(0) {}
 
    void print(AstNode* x) { x->accept(this); }
 
@@ -34,6 +35,7 @@ public:
    void visit_exprstmt(ExprStmt *x);
    void visit_ifstmt(IfStmt *x);
    void visit_iterstmt(IterStmt *x);
+   void visit_switchstmt(SwitchStmt *x);
    void visit_jumpstmt(JumpStmt *x);
    void visit_callexpr(CallExpr *x);
    void visit_indexexpr(IndexExpr *x);
@@ -45,6 +47,8 @@ public:
    void visit_negexpr(NegExpr *x);
    void visit_addrexpr(AddrExpr *x);
    void visit_derefexpr(DerefExpr *x);
+   void visit_newexpr(NewExpr *x);
+   void visit_deleteexpr(DeleteExpr *x);
    void visit_literal(Literal *x);
 
    void visit_errorstmt(Stmt::Error *x);
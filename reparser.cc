@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <sstream>
+#include <typeinfo>
+using namespace std;
+
+#include "reparser.hh"
+#include "parser.hh"
+#include "walker.hh"
+
+// (some nodes are left at the default Pos(1, 0) by the parser, and they
+// stay there)
+static void _shift(Pos& p, int delta) {
+   if (p.lin != 1 or p.col != 0) {
+      p.lin += delta;
+   }
+}
+
+void shift_lines(AstNode *x, int delta) {
+   if (delta == 0) {
+      return;
+   }
+   NodeCollector C;
+   x->accept(&C);
+   for (AstNode *n : C.nodes) {
+      _shift(n->ini, delta);
+      _shift(n->fin, delta);
+      for (Error *e : n->errors) {
+         _shift(e->pos, delta);
+      }
+   }
+}
+
+void Reparser::_index_lines() {
+   _lines.assign(1, 0);
+   const char *text = _text.data(), *end = text + _text.size(), *p = text;
+   while ((p = (const char *)memchr(p, '\n', end - p)) != 0) {
+      _lines.push_back(++p - text);
+   }
+}
+
+int Reparser::_offset(int lin) const {
+   return (lin - 1 < _lines.size() ? _lines[lin - 1] : _text.size());
+}
+
+void Reparser::_parse_all() {
+   delete_tree(_program);
+   istringstream S(_text);
+   ostringstream E;
+   Parser P(&S, &E);
+   _program = dynamic_cast<Program*>(P.parse());
+}
+
+Program *Reparser::parse(string text) {
+   _text = text;
+   _index_lines();
+   _parse_all();
+   _incremental = false;
+   return _program;
+}
+
+// The text of node 'k' runs from the start of its first line to the
+// start of the next node's line, so its trailing comments are reparsed
+// with it, and the result must be a node of the same kind, alone and
+// without errors
+bool Reparser::_reparse(int k, int delta) {
+   vector<AstNode*>& nodes = _program->nodes;
+   AstNode *old = nodes[k];
+   if (!old->is<FuncDecl>() and !old->is<StructDecl>()) {
+      return false;
+   }
+   const int lin = old->ini.lin;
+   const int ini = _offset(lin);
+   const int fin = (k+1 < nodes.size() ? _offset(nodes[k+1]->ini.lin + delta) : _text.size());
+   if (fin <= ini) {
+      return false;
+   }
+   istringstream S(_text.substr(ini, fin - ini));
+   ostringstream E;
+   Parser P(&S, &E, lin);
+   for (int i = 0; i < k; i++) {
+      if (nodes[i]->is<StructDecl>()) {
+         P.declare_type(static_cast<StructDecl*>(nodes[i])->id->name);
+      } else if (nodes[i]->is<TypedefDecl>()) {
+         P.declare_type(static_cast<TypedefDecl*>(nodes[i])->decl->name);
+      } else if (nodes[i]->is<EnumDecl>()) {
+         P.declare_type(static_cast<EnumDecl*>(nodes[i])->name);
+      }
+   }
+   Program *seg = dynamic_cast<Program*>(P.parse());
+   vector<Error*> errors;
+   collect_errors(seg, errors);
+   bool ok = (errors.empty() and seg->nodes.size() == 1 and
+              seg->comments.size() == 2 and seg->comments[0] == 0 and
+              typeid(*seg->nodes[0]) == typeid(*old));
+   if (ok and old->is<StructDecl>()) {
+      ok = (static_cast<StructDecl*>(old)->id->name ==
+            static_cast<StructDecl*>(seg->nodes[0])->id->name);
+   }
+   if (!ok) {
+      delete_tree(seg);
+      return false;
+   }
+   delete_tree(old);
+   nodes[k] = seg->nodes[0];
+   delete _program->comments[k+1];
+   _program->comments[k+1] = seg->comments[1];
+   seg->nodes.clear();
+   seg->comments.clear();
+   delete seg;
+   for (int i = k+1; i < nodes.size(); i++) {
+      shift_lines(nodes[i], delta);
+   }
+   return true;
+}
+
+// The positions in error messages are text, so a program with errors
+// is always parsed again
+Program *Reparser::edit(int first, int last, string text) {
+   assert(first >= 1 and last >= first - 1);
+   const int ini = _offset(first), fin = _offset(last + 1);
+   const int delta = count(text.begin(), text.end(), '\n') -
+                     count(_text.begin() + ini, _text.begin() + fin, '\n');
+   _text.replace(ini, fin - ini, text);
+   _index_lines();
+
+   _incremental = false;
+   vector<Error*> errors;
+   collect_errors(_program, errors);
+   if (_program != 0 and errors.empty()) {
+      const vector<AstNode*>& nodes = _program->nodes;
+      for (int k = 0; k < nodes.size(); k++) {
+         const int next = (k+1 < nodes.size() ? nodes[k+1]->ini.lin : INT_MAX);
+         if (nodes[k]->ini.lin <= first and last < next) {
+            if (k == 0 or nodes[k-1]->fin.lin < nodes[k]->ini.lin) {
+               _incremental = _reparse(k, delta);
+            }
+            break;
+         }
+      }
+   }
+   if (!_incremental) {
+      _parse_all();
+   }
+   return _program;
+}
+
+// The edit goes from the first line that changed to the last one (the
+// lines before and after are the same in both texts)
+Program *Reparser::update(string text) {
+   if (_program == 0) {
+      return parse(text);
+   }
+   if (text == _text) {
+      _incremental = true;
+      return _program;
+   }
+   const int osz = _text.size(), nsz = text.size();
+   int pre = 0;
+   while (pre < min(osz, nsz) and _text[pre] == text[pre]) {
+      pre++;
+   }
+   while (pre > 0 and _text[pre-1] != '\n') {
+      pre--;
+   }
+   int suf = 0;
+   while (suf < min(osz, nsz) - pre and _text[osz-1-suf] == text[nsz-1-suf]) {
+      suf++;
+   }
+   while (suf > 0 and (_text[osz-1-suf] != '\n' or text[nsz-1-suf] != '\n')) {
+      suf--;
+   }
+   const int first = 1 + count(_text.begin(), _text.begin() + pre, '\n');
+   const int last  = (suf == 0 ? _lines.size() // (the last line may have no '\n')
+                      : count(_text.begin(), _text.begin() + (osz - suf), '\n'));
+   return edit(first, last, text.substr(pre, nsz - suf - pre));
+}
@@ -0,0 +1,40 @@
+#ifndef REPARSER_HH
+#define REPARSER_HH
+
+#include <string>
+#include <vector>
+#include "ast.hh"
+
+// Keeps the text of a program and its tree, for the web editor. An edit
+// that falls inside a single top-level function or struct reparses just
+// that one, lexing only its lines: the other top-level nodes are kept as
+// they are, and those below the edit are moved by the number of lines it
+// added or removed. Any other edit (or one which leaves errors, or
+// renames a struct) parses the whole text again.
+
+class Reparser {
+   std::string       _text;
+   std::vector<int>  _lines;       // offset where each line begins (line 1 at [0])
+   Program          *_program;
+   bool              _incremental; // whether the last edit reparsed just one node
+
+   void _index_lines();
+    int _offset(int lin) const;   // where line 'lin' begins (or the end of the text)
+   void _parse_all();
+   bool _reparse(int k, int delta);
+
+public:
+   Reparser() : _program(0), _incremental(false) {}
+
+   Program *parse(std::string text);
+   Program *edit(int first, int last, std::string text); // replaces lines [first, last]
+   Program *update(std::string text);                    // edits the lines that changed
+
+            Program *program()     const { return _program; }
+   const std::string& text()       const { return _text; }
+                bool  incremental() const { return _incremental; }
+};
+
+void shift_lines(AstNode *x, int delta); // moves a subtree 'delta' lines down
+
+#endif
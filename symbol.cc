@@ -0,0 +1,40 @@
+#include <deque>
+#include <unordered_map>
+#include "symbol.hh"
+using namespace std;
+
+namespace {
+
+// The texts never move (a deque only grows at the end), so the
+// references handed out by 'str' stay valid
+struct Texts {
+   deque<string>             texts;
+   unordered_map<string,int> ids;
+   Texts() { 
+      texts.push_back("");
+      ids[""] = 0;
+   }
+};
+
+}
+
+static Texts& _table() {
+   static Texts table;
+   return table;
+}
+
+int Symbol::_intern(const string& s) {
+   Texts& T = _table();
+   auto it = T.ids.find(s);
+   if (it != T.ids.end()) {
+      return it->second;
+   }
+   const int id = T.texts.size();
+   T.texts.push_back(s);
+   T.ids[s] = id;
+   return id;
+}
+
+const string& Symbol::_text(int id) {
+   return _table().texts[id];
+}
@@ -0,0 +1,53 @@
+#ifndef SYMBOL_HH
+#define SYMBOL_HH
+
+#include <string>
+#include <iostream>
+#include <functional>
+
+// A name (or string literal) interned in the symbol table: equal texts
+// are the same Symbol, so comparing them compares two ints, and the
+// text is kept once. 'str' gives it back (and so does the conversion to
+// 'const std::string&'). The table lives as long as the program, so
+// that successive compilations in the web editor share it.
+
+class Symbol {
+   int _id;
+
+   static int _intern(const std::string& s);
+   static const std::string& _text(int id);
+
+public:
+   Symbol()                     : _id(0) {} // ""
+   Symbol(const std::string& s) : _id(_intern(s)) {}
+   Symbol(const char *s)        : _id(_intern(s)) {}
+
+                  int  id()    const { return _id; }
+   const std::string&  str()   const { return _text(_id); }
+          const char  *c_str() const { return str().c_str(); }
+                 bool  empty() const { return _id == 0; }
+                       operator const std::string&() const { return str(); }
+
+   bool operator==(Symbol s)             const { return _id == s._id; }
+   bool operator!=(Symbol s)             const { return _id != s._id; }
+   bool operator==(const std::string& s) const { return str() == s; }
+   bool operator!=(const std::string& s) const { return str() != s; }
+   bool operator==(const char *s)        const { return str() == s; }
+   bool operator!=(const char *s)        const { return str() != s; }
+   bool operator<(Symbol s)              const { return str() < s.str(); }
+};
+
+inline std::string operator+(const std::string& a, Symbol b) { return a + b.str(); }
+inline std::string operator+(Symbol a, const std::string& b) { return a.str() + b; }
+inline std::string operator+(const char *a, Symbol b)        { return a + b.str(); }
+inline std::string operator+(Symbol a, const char *b)        { return a.str() + b; }
+
+inline std::ostream& operator<<(std::ostream& o, Symbol s) { return o << s.str(); }
+
+namespace std {
+   template<> struct hash<Symbol> {
+      size_t operator()(Symbol s) const { return s.id(); }
+   };
+}
+
+#endif
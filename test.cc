@@ -10,9 +10,11 @@ using namespace std;
 #include "type_checker.hh"
 #include "flowcontrol.hh"
 #include "interpreter.hh"
+#include "closures.hh"
 #include "translator.hh"
 #include "stepper.hh"
 #include "walker.hh"
+#include "reparser.hh"
 
 // Detect lines like:
 //
@@ -61,14 +63,121 @@ string visible_spaces(string output, string compare = "") {
    return res;
 }
 
-enum VisitorType { pretty_printer, type_checker, flowcontrol, ast_printer, interpreter, stepper };
+enum VisitorType { 
+   pretty_printer, type_checker, flowcontrol, ast_printer, 
+   interpreter, closures, allocations, stepper, reparser, streamer, 
+   backtracker
+};
+
+// Interpreter which writes, after each statement, how many Values (and 
+// their data) were allocated to execute it, like this:
+//
+//   [line 7: 2 allocations]
+//
+class AllocationCounter : public Interpreter {
+   std::ostream *_report;
+
+   void report(Stmt *x, long before) {
+      *_report << "[line " << x->ini_line() << ": " 
+               << Value::allocations - before << " allocations]" << endl;
+   }
+public:
+   AllocationCounter(istream *i, ostream *o) : Interpreter(i, o), _report(o) {}
+
+   void visit_exprstmt(ExprStmt *x) {
+      long before = Value::allocations;
+      Interpreter::visit_exprstmt(x);
+      report(x, before);
+   }
+   void visit_declstmt(DeclStmt *x) {
+      long before = Value::allocations;
+      Interpreter::visit_declstmt(x);
+      report(x, before);
+   }
+};
 
 void exec_visitor(Program *P, VisitorType vtype) {
 }
 
+// The span of every node, to compare a reparsed tree with a parsed one
+struct SpanCollector : public Walker {
+   ostringstream spans;
+   void walk(AstNode *n) { spans << n->span().ini << '-' << n->span().fin << ' '; }
+};
+
+string spans(AstNode *x) {
+   SpanCollector C;
+   x->accept(&C);
+   return C.spans.str();
+}
+
+string pretty(AstNode *x) {
+   ostringstream out;
+   PrettyPrinter printer(&out);
+   x->accept(&printer);
+   return out.str();
+}
+
+// The [[edit]] section has the first and last lines to replace and then
+// the new lines. The output is the AST after the edit, and whether only
+// one node was reparsed; the positions (and the comments) must be those
+// of a full parse.
+void test_reparser(string code, string edit, ostream& out, ostream& err) {
+   istringstream S(edit);
+   int first, last;
+   S >> first >> last;
+   S.ignore(1);
+   string text = edit.substr(S.tellg());
+
+   Reparser R;
+   R.parse(code);
+   Program *program = R.edit(first, last, text);
+   AstPrinter printer(&out);
+   program->accept(&printer);
+   out << (R.incremental() ? "[one node]" : "[whole]") << endl;
+
+   istringstream Scode(R.text());
+   Parser P(&Scode, &err);
+   AstNode *full = P.parse();
+   if (spans(full) != spans(program)) {
+      err << "positions differ from a full parse" << endl;
+   }
+   if (pretty(full) != pretty(program)) {
+      err << "comments differ from a full parse" << endl;
+   }
+}
+
+// The program is parsed in pieces (as small as they can be) and each one
+// is pretty-printed as it comes. The output is that and the number of
+// pieces; it must be the same as printing the whole program.
+void test_stream(string code, ostream& out, ostream& err) {
+   istringstream S(code);
+   Parser P(&S, &err, 1, 1);
+   ostringstream streamed;
+   PrettyPrinter printer(&streamed);
+   int pieces = 0;
+   P.parse([&](Program *piece) {
+      piece->accept(&printer);
+      vector<Error*> ve;
+      collect_errors(piece, ve);
+      for (Error *e : ve) {
+         err << e->msg << endl;
+      }
+      pieces++;
+   });
+   out << streamed.str() << "[" << pieces << " pieces]" << endl;
+
+   istringstream Scode(code);
+   ostringstream Saux;
+   Parser Pfull(&Scode, &Saux);
+   if (pretty(Pfull.parse()) != streamed.str()) {
+      err << "differs from printing the whole program" << endl;
+   }
+}
+
 void test_visitor(string filename, VisitorType vtype) {
    ifstream F(filename);
-   string line, code, in, out, err;
+   string line, code, in, out, err, edit;
    string *acum = &code;
    while (getline(F, line)) {
       string label = test_separator(line);
@@ -88,6 +197,8 @@ void test_visitor(string filename, VisitorType vtype) {
          acum = &in;
       } else if (label == "err") {
          acum = &err;
+      } else if (label == "edit") {
+         acum = &edit;
       }
    }
 
@@ -97,20 +208,34 @@ void test_visitor(string filename, VisitorType vtype) {
    AstNode *program;
 
    program = P.parse();
-   AstVisitor *v;
+   AstVisitor *v = 0;
    switch (vtype) {
    case pretty_printer: v = new PrettyPrinter(&Sout); break;
    case type_checker:   v = new TypeChecker(&Sout); break;
    case flowcontrol:   v = new FlowControl(&Sout); break;
    case ast_printer:    v = new AstPrinter(&Sout); break;
    case interpreter:    v = new Interpreter(&Sin, &Sout); break;
+   case closures:       v = new ClosureCompiler(&Sin, &Sout); break;
+   case allocations:    v = new AllocationCounter(&Sin, &Sout); break;
    default: break;
    }
 
    // Run it
    try {
       Translator::translator.set_language("es");
-      if (vtype == stepper) {
+      if (vtype == reparser) {
+         test_reparser(code, edit, Sout, Serr);
+      } else if (vtype == streamer) {
+         test_stream(code, Sout, Serr);
+      } else if (vtype == backtracker) {
+         // statements the parser had to read twice
+         Sout << pretty(program) << "[" << P.backtracks() << " backtracks]" << endl;
+         vector<Error*> ve;
+         collect_errors(program, ve);
+         for (Error *e : ve) {
+            Serr << e->msg << endl;
+         }
+      } else if (vtype == stepper) {
          Stepper S(&Sin, &Saux);
          program->accept(&S);
          while (!S.finished()) {
@@ -171,8 +296,18 @@ void test(string kind, string filename) {
       vtype = flowcontrol;
    } else if (kind == "interpreter") {
       vtype = interpreter;
+   } else if (kind == "closures") {
+      vtype = closures;
+   } else if (kind == "allocations") {
+      vtype = allocations;
    } else if (kind == "stepper") {
       vtype = stepper;
+   } else if (kind == "reparser") {
+      vtype = reparser;
+   } else if (kind == "stream") {
+      vtype = streamer;
+   } else if (kind == "backtracks") {
+      vtype = backtracker;
    } else {
        cerr << "El kind seleccionado no existe " << kind << endl;
    }
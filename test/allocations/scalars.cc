@@ -0,0 +1,32 @@
+#include <iostream>
+using namespace std;
+
+int main() {
+   int a = 1, b = 2;
+   double d = 0.5, e = 1.5;
+   string s = "x";
+   a = b;
+   d = e;
+   s = "yz";
+   a += b;
+   d *= e;
+   a %= b;
+   a++;
+   --a;
+   b = a++;
+   b = ++a;
+}
+[[out]]--------------------------------------------------
+[line 5: 8 allocations]
+[line 6: 8 allocations]
+[line 7: 4 allocations]
+[line 8: 0 allocations]
+[line 9: 0 allocations]
+[line 10: 2 allocations]
+[line 11: 0 allocations]
+[line 12: 0 allocations]
+[line 13: 0 allocations]
+[line 14: 0 allocations]
+[line 15: 0 allocations]
+[line 16: 2 allocations]
+[line 17: 0 allocations]
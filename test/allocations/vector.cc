@@ -0,0 +1,19 @@
+#include <iostream>
+#include <vector>
+using namespace std;
+
+int main() {
+   vector<int> v(3);
+   int x = 5;
+   v[0] = x;
+   v[1] += x;
+   v[2]++;
+   x = v[0] * 2;
+}
+[[out]]--------------------------------------------------
+[line 6: 11 allocations]
+[line 7: 4 allocations]
+[line 8: 2 allocations]
+[line 9: 2 allocations]
+[line 10: 2 allocations]
+[line 11: 8 allocations]
@@ -0,0 +1,17 @@
+void f() {
+   a = b | c + d;
+   a = b % c * d + e % f;
+   a %= b | c;
+   a = b & c | d ^ e;
+}
+[[out]]--------------------------------------------------
+Program{
+   FuncDecl(id:'f', Type(id:'void'), Params = {}, {
+      Block({
+         ExprStmt(=(id:'a', |(id:'b', +(id:'c', id:'d'))))
+         ExprStmt(=(id:'a', +(*(%(id:'b', id:'c'), id:'d'), %(id:'e', id:'f'))))
+         ExprStmt(%=(id:'a', |(id:'b', id:'c')))
+         ExprStmt(=(id:'a', |(&(id:'b', id:'c'), ^(id:'d', id:'e'))))
+      })
+   })
+}
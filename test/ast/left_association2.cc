@@ -0,0 +1,9 @@
+void f() { a = b -1 - c * d -2.5 + e or f and g; }
+[[out]]--------------------------------------------------
+Program{
+   FuncDecl(id:'f', Type(id:'void'), Params = {}, {
+      Block({
+         ExprStmt(=(id:'a', or(+(-(-(-(id:'b', Int<1>), *(id:'c', id:'d')), Double<2.5>), id:'e'), and(id:'f', id:'g'))))
+      })
+   })
+}
@@ -0,0 +1,17 @@
+int main() {
+   int *p = new int[10];
+   Node *n = new Node{1, nullptr};
+   delete[] p;
+   delete n;
+}
+[[out]]--------------------------------------------------
+Program{
+   FuncDecl(id:'main', Type(id:'int'), Params = {}, {
+      Block({
+         DeclStmt(Type(id:'int'), Vars = {*"p" = NewExpr(Type(id:'int'), Size = Int<10>)})
+         DeclStmt(Type(id:'Node'), Vars = {*"n" = NewExpr(Type(id:'Node'), Init = {Int<1>, id:'nullptr'})})
+         ExprStmt(DeleteExpr[](id:'p'))
+         ExprStmt(DeleteExpr(id:'n'))
+      })
+   })
+}
@@ -0,0 +1,11 @@
+int f() {
+   x y == z;
+}
+[[out]]-----------------------------------------------------
+int f() {
+   x;
+   ;
+}
+[1 backtracks]
+[[err]]-----------------------------------------------------
+2:5: Expected ';' after expression
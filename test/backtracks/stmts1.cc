@@ -0,0 +1,48 @@
+#include <iostream>
+#include <vector>
+using namespace std;
+
+struct Point { int x, y; };
+typedef vector<Point> Points;
+
+int main() {
+   int n = 3, *p = &n;
+   Point a, b;
+   Points ps(n);
+   vector<vector<int>> m;
+   vector<int>::iterator it;
+   a.x = 1;
+   ps[0] = a;
+   n < 3;
+   n * 2;
+   cout << n << endl;
+   n++;
+   if (n > 0) n = 0; else n = 1;
+   return 0;
+}
+[[out]]-----------------------------------------------------
+#include <iostream>
+#include <vector>
+using namespace std;
+
+struct Point {
+   int x, y;
+};
+typedef vector<Point> Points;
+
+int main() {
+   int n = 3, *p = &n;
+   Point a, b;
+   Points ps(n);
+   vector<vector<int>> m;
+   vector<int>::iterator it;
+   a.x = 1;
+   ps[0] = a;
+   n < 3;
+   n * 2;
+   cout << n << endl;
+   n++;
+   if (n > 0) n = 0; else n = 1;
+   return 0;
+}
+[0 backtracks]
@@ -0,0 +1,20 @@
+int a = 1, b[3];
+int *f(int x);
+const int & r = a;
+map<int, vector<int> > M;
+std::string name;
+int g() {
+   return a;
+}
+[[out]]-----------------------------------------------------
+int a = 1, b[3];
+
+int *f(int x);
+const int& r = a;
+map<int, vector<int>> M;
+std::string name;
+
+int g() {
+   return a;
+}
+[0 backtracks]
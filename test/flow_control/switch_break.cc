@@ -0,0 +1,11 @@
+int main() {
+   int x = 1;
+   switch (x) {
+   case 1:
+      x = 2;
+      break;
+   }
+   break;
+}
+[[err]]--------------------------------------------------
+8,4: break statement outside loop
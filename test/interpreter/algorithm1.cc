@@ -0,0 +1,51 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+using namespace std;
+
+int main() {
+   vector<int> v(6);
+   for (int i = 0; i < 6; i++) {
+      v[i] = (i * 5) % 7;
+   }
+   sort(v.begin(), v.end());
+   for (int i = 0; i < 6; i++) {
+      cout << v[i] << ' ';
+   }
+   cout << endl;
+   cout << accumulate(v.begin(), v.end(), 0) << ' ' << count(v.begin(), v.end(), 3) << endl;
+   cout << *min_element(v.begin(), v.end()) << ' ' << *max_element(v.begin(), v.end()) << endl;
+   cout << find(v.begin(), v.end(), 4) - v.begin() << endl;
+   if (find(v.begin(), v.end(), 2) == v.end()) {
+      cout << "no" << endl;
+   }
+   reverse(v.begin() + 1, v.end());
+   *v.begin() = 9;
+   cout << v[0] << v[1] << v[5] << endl;
+   vector<string> s(3);
+   s[0] = "pera";
+   s[1] = "kiwi";
+   s[2] = "coco";
+   string vacio = "";
+   sort(s.begin(), s.end());
+   cout << s[0] << ' ' << accumulate(s.begin(), s.end(), vacio) << endl;
+   double t[4];
+   t[0] = 2.5;
+   t[1] = 0.5;
+   t[2] = 1.5;
+   t[3] = 3.5;
+   sort(t, t + 4);
+   cout << t[0] << ' ' << accumulate(t, t + 4, 0.0) << endl;
+   cout << accumulate(t, t + 4, 0) << ' ' << accumulate(t, t + 4, 0) % 5 << endl;
+}
+[[out]]--------------------------------------------------
+0 1 3 4 5 6 
+19 1
+0 6
+3
+no
+961
+coco cocokiwipera
+0.5 8
+6 1
@@ -0,0 +1,29 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+int main() {
+   double x = 2.25;
+   int n = -7;
+   cout << sqrt(x) << ' ' << pow(2, 10) << ' ' << pow(x, 0.5) << endl;
+   cout << abs(n) << ' ' << fabs(-1.5) << endl;
+   cout << floor(2.7) << ' ' << ceil(2.2) << ' ' << floor(-2.5) << endl;
+   cout << max(n, 3) << ' ' << min(n, 3) << endl;
+   srand(1);
+   int a = rand();
+   int b = rand();
+   srand(1);
+   cout << a << ' ' << b << ' ' << (rand() == a) << endl;
+   cout << (rand() <= RAND_MAX) << endl;
+   sqrt("hola");
+}
+[[out]]--------------------------------------------------
+1.5 1024 1.5
+7 1.5
+2 3 -3
+3 -7
+16838 5758 1
+1
+[[err]]--------------------------------------------------
+Error de ejecución: El argumento 1 no es compatible con el tipo del parámetro (double vs string)
@@ -0,0 +1,24 @@
+#include <iostream>
+#include <cmath>
+using namespace std;
+
+int main() {
+   double d = -2.5;
+   int n = -7;
+   cout << abs(d) << ' ' << abs(n) << ' ' << abs(-0.25) << endl;
+   int k = abs(n) + 1;
+   cout << k << endl;
+   cout << max(1.5, 2.7) << ' ' << min(1.5, 2.7) << ' ' << max(d, -3.0) << endl;
+   cout << max('a', 'b') << ' ' << min('a', 'b') << ' ' << max(n, 3) % 2 << endl;
+   string a = "pera", b = "kiwi";
+   cout << max(a, b) << ' ' << min(a, b) << endl;
+   abs("hola");
+}
+[[out]]--------------------------------------------------
+2.5 7 0.25
+8
+2.7 1.5 -2.5
+b a 1
+pera kiwi
+[[err]]--------------------------------------------------
+Error de ejecución: El argumento 1 no es compatible con el tipo del parámetro (int vs string)
@@ -0,0 +1,41 @@
+#include <iostream>
+using namespace std;
+
+void salta(int& k) {
+   k = k + 3;
+}
+
+int main() {
+   for (int i = 0; i <= 4; i++) {
+      cout << i;
+   }
+   cout << endl;
+   for (int i = 10; i != 0; i -= 2) {
+      cout << i << ' ';
+   }
+   cout << endl;
+   int n = 3;
+   for (int i = 0; i < n; i++) {
+      if (i == 1) {
+         n = 6;
+      }
+      cout << i;
+   }
+   cout << endl;
+   for (int i = 0; i < 12; ++i) {
+      salta(i);
+      cout << i << ' ';
+   }
+   cout << endl;
+   for (int i = 5; i < 9; i++) {
+      i = i + 1;
+      cout << i << ' ';
+   }
+   cout << endl;
+}
+[[out]]--------------------------------------------------
+01234
+10 8 6 4 2 
+012345
+3 7 11 
+6 8 
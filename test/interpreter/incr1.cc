@@ -0,0 +1,19 @@
+#include <iostream>
+using namespace std;
+
+int main() {
+   int i = 5, j;
+   j = i++;
+   cout << i << ' ' << j << endl;
+   j = ++i;
+   cout << i << ' ' << j << endl;
+   j = i--;
+   cout << i << ' ' << j << endl;
+   j = --i;
+   cout << i << ' ' << j << endl;
+}
+[[out]]--------------------------------------------------
+6 5
+7 7
+6 7
+5 5
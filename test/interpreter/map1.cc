@@ -0,0 +1,78 @@
+#include <iostream>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+using namespace std;
+
+int main() {
+   map<string, int> edad;
+   edad["ana"] = 20;
+   edad["luis"] = 31;
+   edad["ana"] += 1;
+   cout << edad["ana"] << ' ' << edad["luis"] << ' ' << edad["pepe"] << endl;
+   cout << edad.size() << ' ' << edad.count("pepe") << ' ' << edad.count("x") << endl;
+   edad.erase("pepe");
+   cout << edad.size() << endl;
+   edad.insert(make_pair("eva", 40));
+   edad.insert(make_pair("ana", 99));
+   cout << edad["eva"] << ' ' << edad["ana"] << endl;
+   if (edad.find("luis") != edad.end()) {
+      cout << "luis" << endl;
+   }
+   if (edad.find("juan") == edad.end()) {
+      cout << "no juan" << endl;
+   }
+   cout << edad.find("eva")->second << endl;
+   (*edad.find("eva")).second = 41;
+   cout << edad["eva"] << endl;
+
+   set<int> s;
+   for (int i = 0; i < 10; i++) {
+      s.insert(i % 4);
+   }
+   cout << s.size() << ' ' << s.count(3) << ' ' << s.count(7) << endl;
+   cout << *s.find(2) << endl;
+
+   unordered_map<int, int> cuadrados;
+   for (int i = 0; i < 1000; i++) {
+      cuadrados[i] = i * i;
+   }
+   for (int i = 0; i < 1000; i += 2) {
+      cuadrados.erase(i);
+   }
+   cout << cuadrados.size() << ' ' << cuadrados[999] << ' ' << cuadrados.count(500) << endl;
+
+   unordered_set<string> vistos;
+   vistos.insert("a");
+   vistos.insert("b");
+   vistos.insert("a");
+   cout << vistos.size() << ' ' << vistos.empty() << endl;
+
+   map<pair<int, int>, string> puntos;
+   puntos[make_pair(1, 2)] = "A";
+   pair<int, int> p = make_pair(1, 2);
+   cout << puntos[p] << ' ' << p.first << endl;
+
+   map<int, vector<int> > grupos;
+   grupos[3].push_back(1);
+   cout << grupos[3].size() << endl;
+   edad[5] = 1;
+}
+[[out]]--------------------------------------------------
+21 31 0
+3 1 0
+2
+40 21
+luis
+no juan
+40
+41
+4 1 0
+2
+500 998001 0
+2 0
+A 1
+1
+[[err]]--------------------------------------------------
+Error de ejecución: El índice no es compatible con el tipo de las claves (string vs int)
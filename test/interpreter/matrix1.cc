@@ -0,0 +1,57 @@
+#include <iostream>
+#include <vector>
+using namespace std;
+
+struct Tablero {
+   char c[2][3];
+};
+
+int main() {
+   int a[3][4];
+   for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 4; j++) {
+         a[i][j] = i * 10 + j;
+      }
+   }
+   cout << a[2][3] << ' ' << a[1][0] << endl;
+   int b[2][2][2] = {{{1, 2}, {3, 4}}, {{5, 6}, {7, 8}}};
+   cout << b[1][0][1] << ' ' << b[1][1][0] << ' ' << b[1][1][1] << endl;
+   b[0][1][0] += 30;
+   cout << b[0][1][0] << ' ' << b[0][1][1] << endl;
+   int c[2][3] = {{1, 2, 3}, {4, 5, 6}};
+   int s = 0;
+   for (int i = 0; i < 2; i++) {
+      for (int j = 0; j < 3; j++) {
+         s += c[i][j];
+      }
+   }
+   cout << s << endl;
+   Tablero t;
+   t.c[1][2] = 'x';
+   cout << t.c[1][2] << endl;
+   vector<int> fila(3, 0);
+   vector<vector<int>> m(3, fila);
+   for (int i = 0; i < 3; i++) {
+      m[i][i] = 1;
+      m[i][2] = m[i][2] + i;
+   }
+   cout << m[0][0] << m[1][1] << m[2][2] << m[1][2] << m[0][1] << endl;
+   string g[2][2] = {{"ab", "cd"}, {"ef", "gh"}};
+   cout << g[1][0] << g[1][0][1] << endl;
+   const int N = 2;
+   double d[N][3];
+   d[1][2] = 0.5;
+   cout << d[1][2] << endl;
+   cout << a[1][4] << endl;
+}
+[[out]]--------------------------------------------------
+23 10
+6 7 8
+33 4
+21
+x
+11331
+eff
+0.5
+[[err]]--------------------------------------------------
+Error de ejecución: La casilla 4 no existe
@@ -0,0 +1,17 @@
+#include <iostream>
+using namespace std;
+
+int main() {
+   vector<int> v;
+   for (int i = 0; i < 5; i++) {
+      v.push_back(i * i);
+   }
+   string s = "abc";
+   int total = 0;
+   for (int i = 0; i < v.size(); i++) {
+      total = total + v[i] + s.size();
+   }
+   cout << v.size() << ' ' << total << ' ' << v.back() << endl;
+}
+[[out]]--------------------------------------------------
+5 45 16
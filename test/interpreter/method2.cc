@@ -0,0 +1,12 @@
+#include <iostream>
+using namespace std;
+
+int main() {
+   vector<int> v(3);
+   cout << v.size() << endl;
+   v.pop();
+}
+[[out]]--------------------------------------------------
+3
+[[err]]--------------------------------------------------
+Error de ejecución: Este objeto no tiene un campo 'pop'
@@ -0,0 +1,75 @@
+#include <iostream>
+using namespace std;
+
+struct Node {
+   int val;
+   Node *next;
+};
+
+Node *push(Node *head, int v) {
+   Node *n = new Node;
+   n->val = v;
+   n->next = head;
+   return n;
+}
+
+int length(Node *p) {
+   int n = 0;
+   while (p != nullptr) {
+      n++;
+      p = p->next;
+   }
+   return n;
+}
+
+void destroy(Node *p) {
+   while (p != nullptr) {
+      Node *next = p->next;
+      delete p;
+      p = next;
+   }
+}
+
+void inc(int *p) {
+   *p = *p + 1;
+}
+
+int main() {
+   Node *list = nullptr;
+   for (int i = 1; i <= 4; i++) {
+      list = push(list, i * 10);
+   }
+   cout << length(list) << ' ' << list->val << ' ' << (*list).next->val << endl;
+   int x = 5;
+   int *px = &x;
+   inc(px);
+   inc(&x);
+   cout << x << ' ' << *px << ' ' << (px == &x) << endl;
+   int *t = new int[5];
+   for (int i = 0; i < 5; i++) {
+      t[i] = i * i;
+   }
+   cout << t[4] << ' ' << *(t + 2) << endl;
+   delete[] t;
+   Node *m = new Node{7, nullptr};
+   cout << m->val << ' ' << (m->next == nullptr) << endl;
+   double *d = new double(2.5);
+   cout << *d << endl;
+   delete d;
+   int *q;
+   q = 0;
+   Node *e = 0;
+   cout << (q == nullptr) << ' ' << (e == 0) << ' ' << (list != 0) << endl;
+   destroy(list);
+   destroy(nullptr);
+   cout << list->val << endl;
+}
+[[out]]--------------------------------------------------
+4 40 30
+7 7 1
+16 4
+7 1
+2.5
+1 1 1
+[[err]]--------------------------------------------------
+Error de ejecución: El puntero apunta a memoria que ya se ha liberado
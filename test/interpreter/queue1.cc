@@ -0,0 +1,74 @@
+#include <iostream>
+#include <stack>
+#include <queue>
+#include <deque>
+using namespace std;
+
+int main() {
+   stack<int> s;
+   for (int i = 0; i < 5; i++) {
+      s.push(i * i);
+   }
+   cout << s.size() << ' ' << s.top() << endl;
+   s.pop();
+   s.top() = 100;
+   cout << s.top() << endl;
+
+   queue<string> q;
+   q.push("a");
+   q.push("b");
+   string x = "c";
+   q.push(x);
+   x = "z";
+   cout << q.front() << q.back() << ' ' << q.size() << endl;
+   q.pop();
+   cout << q.front() << endl;
+
+   deque<int> d;
+   for (int i = 0; i < 20; i++) {
+      if (i % 2 == 0) {
+         d.push_back(i);
+      } else {
+         d.push_front(i);
+      }
+   }
+   d.pop_front();
+   d.pop_back();
+   d[0] = -1;
+   cout << d.size() << ' ' << d.front() << ' ' << d.back() << ' ' << d[1] << endl;
+
+   priority_queue<int> pq;
+   pq.push(3);
+   pq.push(9);
+   pq.push(1);
+   pq.push(5);
+   while (!pq.empty()) {
+      cout << pq.top() << ' ';
+      pq.pop();
+   }
+   cout << endl;
+
+   priority_queue<pair<int, int>, vector<pair<int, int> >, greater<pair<int, int> > > dist;
+   dist.push(make_pair(7, 1));
+   dist.push(make_pair(2, 5));
+   dist.push(make_pair(2, 3));
+   while (!dist.empty()) {
+      pair<int, int> p = dist.top();
+      cout << p.first << ',' << p.second << ' ';
+      dist.pop();
+   }
+   cout << endl;
+
+   queue<int> vacia;
+   vacia.pop();
+}
+[[out]]--------------------------------------------------
+5 16
+100
+ac 3
+b
+18 -1 16 15
+9 5 3 1 
+2,3 2,5 7,1 
+[[err]]--------------------------------------------------
+Error de ejecución: El contenedor está vacío
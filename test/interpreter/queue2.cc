@@ -0,0 +1,13 @@
+#include <iostream>
+#include <queue>
+using namespace std;
+int main() {
+   priority_queue<int> q;
+   int x;
+   q.push(3);
+   q.push(x);
+   q.push(5);
+   cout << q.top() << ' ' << q.size() << endl;
+}
+[[out]]--------------------------------------------------
+5 3
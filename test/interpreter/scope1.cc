@@ -0,0 +1,37 @@
+#include <iostream>
+using namespace std;
+
+int n = 100;
+
+int suma(int k) {
+   int s = 0;
+   if (k > 0) {
+      s = k + suma(k - 1);
+   }
+   return s;
+}
+
+void doble(int& x) {
+   x = x * 2;
+}
+
+int main() {
+   int t = 1;
+   for (int n = 0; n < 3; n++) {
+      int t = n * 10;
+      for (int n = 5; n < 7; n++) {
+         t += n;
+      }
+      cout << n << ' ' << t << endl;
+   }
+   cout << n << ' ' << t << ' ' << suma(4) << endl;
+   doble(t);
+   doble(n);
+   cout << t << ' ' << n << endl;
+}
+[[out]]--------------------------------------------------
+0 11
+1 21
+2 31
+100 1 10
+2 200
@@ -0,0 +1,28 @@
+#include <iostream>
+using namespace std;
+
+int x = 1;
+
+void muestra() {
+   cout << x << ' ';
+}
+
+void usa() {
+   cout << y << endl;
+   y = y + 1;
+}
+
+int main() {
+   muestra();
+   int x = 5;
+   muestra();
+   for (int x = 8; x < 10; x++) {
+      muestra();
+   }
+   int y = 7;
+   usa();
+   usa();
+}
+[[out]]--------------------------------------------------
+1 5 8 9 7
+8
@@ -0,0 +1,31 @@
+#include <iostream>
+#include <vector>
+using namespace std;
+
+struct P {
+   int x, y;
+};
+
+int main() {
+   vector<int> v(3, 7);
+   v = v;
+   cout << v.size() << ' ' << v[2] << endl;
+   P p;
+   p.x = 1;
+   p.y = 2;
+   p = p;
+   cout << p.x << ' ' << p.y << endl;
+   string s = "hola";
+   s = s;
+   cout << s << endl;
+   vector<vector<int>> m(2);
+   m[1] = v;
+   m[1] = m[1];
+   m = m;
+   cout << m[1][0] << endl;
+}
+[[out]]--------------------------------------------------
+3 7
+1 2
+hola
+7
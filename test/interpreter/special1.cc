@@ -0,0 +1,36 @@
+#include <iostream>
+using namespace std;
+
+int main() {
+   int a = 0, b = 0;
+   double d = 0.5;
+   string s = "";
+   bool par = true;
+   for (int i = 0; i < 6; i++) {
+      a = a + i * 3 - 1;
+      b = (b ^ i) | (i & 2);
+      d = d * 2.0 - 0.25;
+      s = s + "x";
+      par = (i % 2 == 0) && (a != 7) || (s < "xxx");
+      cout << a << ' ' << b << ' ' << d << ' ' << s << ' ' << par << ' ' << (a >= b) << endl;
+   }
+   int u;
+   for (int i = 0; i < 4; i++) {
+      int c;
+      if (i < 3) {
+         c = i;
+      }
+      cout << (u == 3) << ' ' << (c == 1) << ' ' << (c != 1) << endl;
+   }
+}
+[[out]]--------------------------------------------------
+-1 0 0.75 x 1 0
+1 1 1.25 xx 1 1
+6 3 2.25 xxx 1 1
+14 2 4.25 xxxx 0 1
+25 6 8.25 xxxxx 1 1
+39 3 16.25 xxxxxx 0 1
+0 0 1
+0 1 0
+0 0 1
+0 0 1
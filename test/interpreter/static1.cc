@@ -0,0 +1,29 @@
+#include <iostream>
+#include <vector>
+using namespace std;
+
+int x = 3;
+
+void doble() {
+   cout << x + x << endl;
+}
+
+int main() {
+   vector<int> v(4);
+   for (int i = 0; i < 4; i++) {
+      v[i] = i * i;
+   }
+   cout << v[3] + v[1] << endl;
+   doble();
+   string x = "ab";
+   doble();
+   bool menor = v[1] < v[2];
+   if (menor == true) {
+      cout << "menor" << endl;
+   }
+}
+[[out]]--------------------------------------------------
+10
+6
+abab
+menor
@@ -0,0 +1,53 @@
+#include <iostream>
+#include <string>
+using namespace std;
+
+int main() {
+   string s = "hola mundo";
+   cout << s.size() << ' ' << s.length() << ' ' << s.empty() << endl;
+   cout << s.find("mundo") << ' ' << s.find('o') << ' ' << s.find('o', 2) << ' ' << s.rfind('o') << endl;
+   if (s.find("adios") == string::npos) {
+      cout << "no" << endl;
+   }
+   int i = 5;
+   cout << s.substr(i) << '|' << s.substr(0, 4) << '|' << s.at(1) << endl;
+   s.push_back('!');
+   s.insert(4, ",");
+   cout << s << endl;
+   s.erase(4, 1);
+   s.pop_back();
+   s.replace(0, 4, "adios");
+   cout << s << ' ' << s.compare("adios") << ' ' << s.compare("z") << endl;
+   string t = s.c_str();
+   for (int k = 0; k < t.size(); k++) {
+      if (t[k] == 'o') {
+         t[k] = '0';
+      }
+   }
+   cout << t << ' ' << t[0] << endl;
+
+   string r = "";
+   string u;
+   u = "";
+   for (int k = 0; k < 5; k++) {
+      r = r + 'a';
+      r = r + "b";
+      u += 'c';
+   }
+   cout << r << ' ' << u << ' ' << r + '!' << endl;
+   t.clear();
+   cout << t.empty() << endl;
+   s.substr(50);
+}
+[[out]]--------------------------------------------------
+10 10 0
+5 1 9 9
+no
+mundo|hola|o
+hola, mundo!
+adios mundo 1 -1
+adi0s mund0 a
+ababababab ccccc ababababab!
+1
+[[err]]--------------------------------------------------
+Error de ejecución: La posición 50 no existe en el string
@@ -0,0 +1,94 @@
+#include <iostream>
+using namespace std;
+
+string dia(int d) {
+   string s;
+   switch (d) {
+   case 1:
+      s = "lunes";
+      break;
+   case 2:
+      s = "martes";
+      break;
+   case 6:
+   case 7:
+      s = "fin de semana";
+      break;
+   default:
+      s = "otro";
+   }
+   return s;
+}
+
+int puntos(char c) {
+   int p = 0;
+   switch (c) {
+   case 'a':
+      p += 1;
+   case 'b':
+      p += 10;
+      break;
+   case 'z':
+      p = 100;
+   }
+   return p;
+}
+
+int main() {
+   for (int i = 0; i < 8; i++) {
+      cout << dia(i) << endl;
+   }
+   cout << puntos('a') << " " << puntos('b') << " " << puntos('z') << " " << puntos('x') << endl;
+   int n = 0;
+   for (int i = 0; i < 100; i++) {
+      switch (i % 1000) {
+      case 5:
+         n += 1;
+         break;
+      case 500:
+         n += 1000;
+         break;
+      case -3:
+         n -= 50;
+         break;
+      case 99:
+         int k = i * 2;
+         n += k;
+      }
+      if (i == 50) {
+         break;
+      }
+   }
+   cout << n << endl;
+   int j = 0;
+   while (true) {
+      j++;
+      if (j > 10) {
+         break;
+      }
+   }
+   cout << j << endl;
+   switch (n) {
+   case 1: case 2:
+      cout << "no" << endl;
+   }
+   switch (3.5) {
+   default:
+      cout << "?" << endl;
+   }
+}
+[[out]]--------------------------------------------------
+otro
+lunes
+martes
+otro
+otro
+otro
+fin de semana
+fin de semana
+11 10 100 0
+1
+11
+no
+[[err]]--------------------------------------------------
+Error de ejecución: Un 'switch' sólo admite valores enteros o caracteres
@@ -0,0 +1,33 @@
+#include <iostream>
+using namespace std;
+
+int main() {
+   int cuenta[3] = {0, 0, 0};
+   for (int i = 0; i < 30; i++) {
+      switch (i % 3) {
+      case 0:
+         cuenta[0]++;
+         break;
+      case 1:
+         cuenta[1]++;
+         if (i > 20) {
+            break;
+         }
+         cuenta[1]++;
+         break;
+      default:
+         cuenta[2]++;
+      }
+   }
+   cout << cuenta[0] << " " << cuenta[1] << " " << cuenta[2] << endl;
+   switch (1) {
+   case 1:
+      cout << "uno" << endl;
+   case 0 + 1:
+      cout << "repetido" << endl;
+   }
+}
+[[out]]--------------------------------------------------
+10 17 10
+[[err]]--------------------------------------------------
+Error de ejecución: El valor 1 aparece en dos 'case'
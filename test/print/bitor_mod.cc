@@ -0,0 +1,13 @@
+void f() {
+   a = b|c  + d;
+   a = b %c*d +e%f;
+   a%=b | c;
+   a = (b | c) % d;
+}
+[[out]]--------------------------------------------------
+void f() {
+   a = b | c + d;
+   a = b % c * d + e % f;
+   a %= b | c;
+   a = (b | c) % d;
+}
@@ -0,0 +1,23 @@
+int main() {
+   int x = 2;
+   switch (x) { // elige
+   case 1: // uno
+      x++;
+      break;
+   /* nada */
+   default:
+      x--; // resta
+   }
+}
+[[out]]--------------------------------------------------
+int main() {
+   int x = 2;
+   switch (x) { // elige
+   case 1: // uno
+      x++;
+      break;
+   /* nada */
+   default:
+      x--; // resta
+   }
+}
@@ -0,0 +1,26 @@
+int f(int x) {
+   return x;
+}
+// f is the identity
+
+int main() {
+   int a = f(2);
+}
+[[edit]]-----------------------------------------------------
+4 4
+// f is the identity
+// (and it has no side effects)
+[[out]]-----------------------------------------------------
+Program{
+   FuncDecl(id:'f', Type(id:'int'), Params = {"x": Type(id:'int')}, {
+      Block({
+         ExprStmt<return>(id:'x')
+      })
+   })
+   FuncDecl(id:'main', Type(id:'int'), Params = {}, {
+      Block({
+         DeclStmt(Type(id:'int'), Vars = {"a" = CallExpr(id:'f', Args = {Int<2>})})
+      })
+   })
+}
+[one node]
@@ -0,0 +1,41 @@
+#include <iostream>
+using namespace std;
+
+int f(int x) {
+   return x + 1;
+}
+
+// g doubles
+int g(int x) {
+   return 2 * x;
+}
+
+int main() {
+   cout << f(g(1)) << endl;
+}
+[[edit]]-----------------------------------------------------
+10 10
+   int y = 2 * x;
+   return y;
+[[out]]-----------------------------------------------------
+Program{
+   Include(<iostream>)
+   Using(std)
+   FuncDecl(id:'f', Type(id:'int'), Params = {"x": Type(id:'int')}, {
+      Block({
+         ExprStmt<return>(+(id:'x', Int<1>))
+      })
+   })
+   FuncDecl(id:'g', Type(id:'int'), Params = {"x": Type(id:'int')}, {
+      Block({
+         DeclStmt(Type(id:'int'), Vars = {"y" = *(Int<2>, id:'x')})
+         ExprStmt<return>(id:'y')
+      })
+   })
+   FuncDecl(id:'main', Type(id:'int'), Params = {}, {
+      Block({
+         ExprStmt(<<(<<(id:'cout', CallExpr(id:'f', Args = {CallExpr(id:'g', Args = {Int<1>})})), id:'endl'))
+      })
+   })
+}
+[one node]
@@ -0,0 +1,40 @@
+#include <iostream>
+using namespace std;
+
+int f(int x) {
+   return x + 1;
+}
+
+int main() {
+   int a = 1;
+   cout << f(a) << endl;
+}
+[[edit]]-----------------------------------------------------
+5 5
+   return x + 1;
+}
+
+int h(int x) {
+   return x - 1;
+[[out]]-----------------------------------------------------
+Program{
+   Include(<iostream>)
+   Using(std)
+   FuncDecl(id:'f', Type(id:'int'), Params = {"x": Type(id:'int')}, {
+      Block({
+         ExprStmt<return>(+(id:'x', Int<1>))
+      })
+   })
+   FuncDecl(id:'h', Type(id:'int'), Params = {"x": Type(id:'int')}, {
+      Block({
+         ExprStmt<return>(-(id:'x', Int<1>))
+      })
+   })
+   FuncDecl(id:'main', Type(id:'int'), Params = {}, {
+      Block({
+         DeclStmt(Type(id:'int'), Vars = {"a" = Int<1>})
+         ExprStmt(<<(<<(id:'cout', CallExpr(id:'f', Args = {id:'a'})), id:'endl'))
+      })
+   })
+}
+[whole]
@@ -0,0 +1,24 @@
+struct Point {
+   int x, y;
+};
+
+int main() {
+   Point p;
+   p.x = 1;
+}
+[[edit]]-----------------------------------------------------
+2 2
+   int x, y, z;
+[[out]]-----------------------------------------------------
+Program{
+   StructDecl(id:'Point', {
+      DeclStmt(Type(id:'int'), Vars = {"x", "y", "z"})
+   })
+   FuncDecl(id:'main', Type(id:'int'), Params = {}, {
+      Block({
+         DeclStmt(Type(id:'Point'), Vars = {"p"})
+         ExprStmt(=(FieldExpr(id:'p', id:'x'), Int<1>))
+      })
+   })
+}
+[one node]
@@ -0,0 +1,24 @@
+struct Point {
+   int x, y;
+};
+
+int main() {
+   Point p;
+   p.x = 1;
+}
+[[edit]]-----------------------------------------------------
+1 1
+struct Punto {
+[[out]]-----------------------------------------------------
+Program{
+   StructDecl(id:'Punto', {
+      DeclStmt(Type(id:'int'), Vars = {"x", "y"})
+   })
+   FuncDecl(id:'main', Type(id:'int'), Params = {}, {
+      Block({
+         DeclStmt(Type(id:'Point'), Vars = {"p"})
+         ExprStmt(=(FieldExpr(id:'p', id:'x'), Int<1>))
+      })
+   })
+}
+[whole]
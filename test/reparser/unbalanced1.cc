@@ -0,0 +1,24 @@
+int f(int x) {
+   return x;
+}
+
+int main() {
+   int a = f(2);
+}
+[[edit]]-----------------------------------------------------
+2 2
+   if (x > 0) {
+      return x;
+[[out]]-----------------------------------------------------
+Program{
+   FuncDecl(id:'f', Type(id:'int'), Params = {"x": Type(id:'int')}, {
+      Block({
+         IfStmt(>(id:'x', Int<0>), Block({
+            ExprStmt<return>(id:'x')
+         }))
+         ExprStmt(id:'int')
+         DeclStmt(Type(id:'int'), Vars = {"a" = CallExpr(id:'f', Args = {Int<2>})})
+      })
+   })
+}
+[whole]
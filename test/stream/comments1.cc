@@ -0,0 +1,23 @@
+// at the beginning
+
+int a;    /* after a */
+   /* before b */ int b;
+int main() {
+   if (a > b) {
+      a = b;
+   }
+}
+// at the end
+[[out]]-----------------------------------------------------
+// at the beginning
+
+int a; /* after a */
+/* before b */int b;
+
+int main() {
+   if (a > b) {
+      a = b;
+   }
+}
+// at the end
+[3 pieces]
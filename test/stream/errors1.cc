@@ -0,0 +1,14 @@
+int x;
++
+int f() {
+   return 1;
+}
+[[out]]-----------------------------------------------------
+int x;
+
+int f() {
+   return 1;
+}
+[2 pieces]
+[[err]]-----------------------------------------------------
+No esperaba '+' aquí.
@@ -0,0 +1,35 @@
+#include <iostream>
+using namespace std;
+
+// first
+int f(int a) {
+   return a + 1;
+}
+int g(int b) {
+   return f(b) * 2;
+}
+
+/* last */
+int main() {
+   cout << g(3) << endl;
+}
+[[out]]-----------------------------------------------------
+#include <iostream>
+using namespace std;
+
+// first
+
+int f(int a) {
+   return a + 1;
+}
+
+int g(int b) {
+   return f(b) * 2;
+}
+
+/* last */
+
+int main() {
+   cout << g(3) << endl;
+}
+[5 pieces]
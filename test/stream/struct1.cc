@@ -0,0 +1,24 @@
+struct Point {
+   int x, y;
+};
+
+Point origin() {
+   Point p;
+   p.x = 0;
+   p.y = 0;
+   return p;
+}
+int n = 3; // global
+[[out]]-----------------------------------------------------
+struct Point {
+   int x, y;
+};
+
+Point origin() {
+   Point p;
+   p.x = 0;
+   p.y = 0;
+   return p;
+}
+int n = 3; // global
+[3 pieces]
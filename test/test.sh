@@ -10,11 +10,12 @@ fi
 
 function test_dir() {
    dir=$(echo $1 | tr -d './');
+   kind=${2:-$dir}
    if [ $verbose == "true" ]; then
-      echo $dir
+      echo $kind
       echo "--------------"
    else
-      printf "%11s  " $dir
+      printf "%11s  " $kind
    fi
    if [ $verbose = "true" ]; then echo; fi
    for ccfile in $(find $dir -name "*.cc" | sort | xargs -n $colsize | sed '2,$s/^/<endl> /'); do
@@ -26,10 +27,10 @@ function test_dir() {
          if [ $verbose = "true" ]; then
             echo -n $ccfile" "
          fi
-         ../minicc --test-${dir} $ccfile 2>> ${dir}-err
+         ../minicc --test-${kind} $ccfile 2>> ${kind}-err
          code=$?
          if [ $code -ne 0 ]; then
-            echo "[error code $code in $ccfile]" >> ${dir}-err
+            echo "[error code $code in $ccfile]" >> ${kind}-err
             echo -n "E"
          fi
          if [ $verbose = "true" ]; then echo; fi
@@ -42,13 +43,20 @@ DIRS=$*
 if [ -z "$DIRS" ]; then
     DIRS=$(find -mindepth 1 -maxdepth 1 -type d | sort)
 fi
+KINDS=""
 for dir in $DIRS; do
    test_dir $dir
+   KINDS="$KINDS $dir"
+   # The interpreter tests are also run with the closure compiler
+   if [ $(echo $dir | tr -d './') = "interpreter" ]; then
+      test_dir $dir closures
+      KINDS="$KINDS closures"
+   fi
 done
-for dir in $DIRS; do
-   if [ -f ${dir}-err ]; then
-      cat ${dir}-err > /dev/stderr
-      rm ${dir}-err
+for kind in $KINDS; do
+   if [ -f ${kind}-err ]; then
+      cat ${kind}-err > /dev/stderr
+      rm ${kind}-err
    fi
 done
 
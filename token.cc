@@ -1,5 +1,7 @@
 
 #include <iostream>
+#include <assert.h>
+#include <string.h>
 #include "token.hh"
 using namespace std;
 
@@ -7,7 +9,7 @@ using namespace std;
 // Hay que dejarla antes que el _table...
 //
 struct { 
-   string      s; 
+   const char *s; 
    Token::Kind t; 
    int         k;
 } toktab[] = {
@@ -70,6 +72,8 @@ struct {
    { "while",    Token::While,    Token::Control },
    { "for",      Token::For,      Token::Control },
    { "switch",   Token::Switch,   Token::Control },
+   { "case",     Token::Case,     Token::Control },
+   { "default",  Token::Default,  Token::Control },
    { "break",    Token::Break,    Token::Control },
    { "continue", Token::Continue, Token::Control },
    { "goto",     Token::Goto,     Token::Control },
@@ -80,6 +84,8 @@ struct {
    { "class",    Token::Class,    Token::None },
    { "typedef",  Token::Typedef,  Token::None },
    { "enum",     Token::Enum,     Token::None },
+   { "new",      Token::New,      Token::None },
+   { "delete",   Token::Delete,   Token::None },
 
    // simple_type_specifier
    { "void",     Token::Void,     Token::TypeSpec | Token::BasicType },
@@ -119,15 +125,48 @@ struct {
 
 Token::Table Token::_table;
 
+unsigned Token::Table::key(const char *s, int len) {
+   const unsigned char *u = (const unsigned char *)s;
+   if (len == 0) {
+      return 0;
+   }
+   return u[0] | (len > 1 ? u[1] : 0) << 8 | u[len-1] << 16 | unsigned(len) << 24;
+}
+
+// Puts every entry of 'toktab' in its slot, false if two different ones
+// collide. A repeated string takes the later entry.
+bool Token::Table::fill(unsigned mult) {
+   _mult = mult;
+   for (int i = 0; i < Size; i++) {
+      _slots[i] = Entry();
+   }
+   for (int i = 0; strcmp(toktab[i].s, "END") != 0; i++) {
+      const int len = strlen(toktab[i].s);
+      Entry& e = _slots[slot(toktab[i].s, len)];
+      if (e.s != 0 and strcmp(e.s, toktab[i].s) != 0) {
+         return false;
+      }
+      e.s   = toktab[i].s;
+      e.len = len;
+      e.kind  = toktab[i].t;
+      e.group = toktab[i].k;
+   }
+   return true;
+}
+
 Token::Table::Table() {
-   int i = 0;
-   while (toktab[i].s != "END") {
-      _table._map[toktab[i].s] = Token(toktab[i].t, toktab[i].k);
-      i++;
+   unsigned mult = 2654435769u; // 2^32 / golden ratio
+   int tries = 0;
+   while (!fill(mult)) {
+      mult += 2;
+      assert(++tries < 1000000);
    }
 }
 
-Token Token::token2type(std::string tok) {
-   auto it = _table._map.find(tok);
-   return (it != _table._map.end() ? it->second : Token(Token::Unknown, Token::Ident));
+Token Token::token2type(const char *tok, int len) {
+   const Table::Entry& e = _table._slots[_table.slot(tok, len)];
+   if (e.len == len and memcmp(e.s, tok, len) == 0) {
+      return Token(e.kind, e.group);
+   }
+   return Token(Token::Unknown, Token::Ident);
 }
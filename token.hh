@@ -2,7 +2,6 @@
 #define TOKEN_HH
 
 #include <string>
-#include <map>
 
 class Token {
 public:
@@ -13,9 +12,10 @@ public:
       Sharp, Not, Amp, Pipe, Star, Slash, Percent, Div,
       Plus, Minus, PlusPlus, MinusMinus,
       LCurly, RCurly, LParen, LBrack, Dot, Arrow,
-      If, Else, While, For, Switch, 
+      If, Else, While, For, Switch, Case, Default,
       Break, Continue, Goto, Return,
       Typedef, Class, Struct, Enum,
+      New, Delete,
       Using, 
       StarAssign, SlashAssign, DivAssign, LShiftAssign, RShiftAssign,
       Or, BarBar, And, AmpAmp, Bar, Circum,
@@ -35,19 +35,39 @@ public:
       Operator = 8, Control = 16, BasicType = 32, TypeQual = 64
    };
    
-   static Token token2type(std::string tok);
+   static Token token2type(const char *tok, int len);
+   static Token token2type(std::string tok) { 
+      return token2type(tok.data(), tok.size()); 
+   }
 
-   int ini, fin;
+   int  ini, fin; // offsets of its text (see Input::str)
    Kind kind;
    int  group;
-   std::string str;
 
    Token(Kind _k = Unknown, int _g = None) 
       : kind(_k), group(_g), ini(-1), fin(-1) {}
 
 private:
+   // Keywords and operators in a perfect hash: the key packs the length
+   // and the first, second and last characters, and the multiplier is
+   // searched (once, at startup) so that no two entries share a slot
    struct Table { 
-      std::map<std::string, Token> _map;
+      enum { Bits = 9, Size = 1 << Bits };
+      struct Entry {
+         const char *s;
+         int         len;
+         Kind        kind;
+         int         group;
+         Entry() : s(0), len(-1), kind(Unknown), group(None) {}
+      };
+      Entry    _slots[Size];
+      unsigned _mult;
+
+      static unsigned key(const char *s, int len);
+      int  slot(const char *s, int len) const { 
+         return (key(s, len) * _mult) >> (32 - Bits); 
+      }
+      bool fill(unsigned mult);
       Table(); 
    };
    static Table _table;
@@ -213,6 +213,14 @@ const char* Translator::_translations[100][Translator::NUM_LANGS] = { /*
       "The type '%s' is not implemented in MiniCC.",
       "El tipo '%s' no se ha implementado en MiniCC.",
       "El tipus '%s' no està implementat a MiniCC."
+   }, {
+      "Expected 'case' or 'default' here.",
+      "Esperaba un 'case' o un 'default' aquí.",
+      "Esperava un 'case' o un 'default' aquí."
+   }, {
+      "There are two 'default' in the same 'switch'.",
+      "Hay dos 'default' en el mismo 'switch'.",
+      "Hi ha dos 'default' al mateix 'switch'."
    },
    { "END" }
 };
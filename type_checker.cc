@@ -517,6 +517,9 @@ void TypeChecker::visit_arraydecl(ArrayDecl *x) {
    if (dbg) cout << "visit arraydecl" << endl;
    //out() << '"' << x->name << "\"(Size = ";
    x->size->accept(this);
+   for (Expr *size : x->subsizes) {
+      size->accept(this);
+   }
    /*
    if (x->init) {
       //out() << ", Init = ";
@@ -623,6 +626,18 @@ void TypeChecker::visit_iterstmt(IterStmt *x) {
    symTable.scope_stack.pop_back();
 }
 
+//the cases of a switch share one scope
+void TypeChecker::visit_switchstmt(SwitchStmt *x) {
+   x->cond->accept(this);
+   symTable.scope_stack.push_back(Scope());
+   for (SwitchStmt::Case& c : x->cases) {
+      for (Stmt *s : c.stmts) {
+         s->accept(this);
+      }
+   }
+   symTable.scope_stack.pop_back();
+}
+
 void TypeChecker::visit_exprstmt(ExprStmt* x) {
    if (dbg) cout << "visit exprstmt" << endl;
    if (x->expr) {
@@ -941,6 +956,22 @@ void TypeChecker::visit_derefexpr(DerefExpr *x) {
    //is an address, and assign expr_type to ???
 }
 
+void TypeChecker::visit_newexpr(NewExpr *x) {
+   if (dbg) cout << "visit newexpr" << endl;
+   if (x->size) {
+      x->size->accept(this);
+   }
+   if (x->init) {
+      x->init->accept(this);
+   }
+   expr_type = new Pointer_type(Var_type::convertTypeSpec(x->typespec));
+}
+
+void TypeChecker::visit_deleteexpr(DeleteExpr *x) {
+   if (dbg) cout << "visit deleteexpr" << endl;
+   x->expr->accept(this);
+}
+
 // i dont know what is this  //////////////////////////////////////////////
 
 void TypeChecker::visit_errorstmt(Stmt::Error *x) {}
@@ -137,7 +137,7 @@ struct FuncHeader {
 //be defined in inner scopes, so the scope must include both
 //the table of variables and the table of types
 struct Scope {
-   std::unordered_map<std::string,Variable*> ident2variable;
+   std::unordered_map<Symbol,Variable*> ident2variable;
    std::map<std::string,Var_type*> ident2type; //for typedefs, structs, enums and so on
 };
 
@@ -164,7 +164,7 @@ struct SymbolTable {
    bool contains(std::string id);
    Var_type* getType(std::string id);
    std::vector<Scope> scope_stack;
-   std::unordered_map<std::string,std::vector<FuncHeader*> > ident2func;
+   std::unordered_map<Symbol,std::vector<FuncHeader*> > ident2func;
 };
 
 class TypeChecker : public AstVisitor, public ReadWriter {
@@ -202,6 +202,7 @@ public:
    void visit_exprstmt(ExprStmt *x);
    void visit_ifstmt(IfStmt *x);
    void visit_iterstmt(IterStmt *x);
+   void visit_switchstmt(SwitchStmt *x);
    void visit_jumpstmt(JumpStmt *x);
    void visit_callexpr(CallExpr *x);
    void visit_indexexpr(IndexExpr *x);
@@ -213,6 +214,8 @@ public:
    void visit_negexpr(NegExpr *x);
    void visit_addrexpr(AddrExpr *x);
    void visit_derefexpr(DerefExpr *x);
+   void visit_newexpr(NewExpr *x);
+   void visit_deleteexpr(DeleteExpr *x);
    void visit_paramdecl(ParamDecl *x);
 
    void visit_errorstmt(Stmt::Error *x);
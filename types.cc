@@ -1,6 +1,7 @@
 
 #include <vector>
 #include <sstream>
+#include <algorithm>
 using namespace std;
 
 #include "types.hh"
@@ -13,6 +14,9 @@ void _error(std::string msg) {
 
 map<string, Type*> Type::_typecache;
 map<string, Type*> Type::_global_namespace;
+map<pair<Type*, int>, Array*> Array::_arrays;
+map<pair<Type*, vector<int>>, MultiArray*> MultiArray::_arrays;
+map<pair<Type*, Type*>, Struct*> Pair::_pairs;
 
 Int         *Int::self         = new Int();
 Float       *Float::self       = new Float();
@@ -24,6 +28,27 @@ Ostream     *Ostream::self     = new Ostream();
 Istream     *Istream::self     = new Istream();
 VectorValue *VectorValue::self = new VectorValue();
 Vector      *Vector::self      = new Vector();
+Iterator    *Iterator::self    = new Iterator();
+Pair        *Pair::self        = new Pair();
+KeyIterator *KeyIterator::self = new KeyIterator();
+map<Type*, Pointer*> Pointer::_pointers;
+Pointer *Pointer::null = Pointer::mkpointer(0);
+
+static Map *_map_templates[] = {
+   new Map("map",           true,  false),
+   new Map("set",           true,  true),
+   new Map("unordered_map", false, false),
+   new Map("unordered_set", false, true),
+};
+
+static Type *_adapter_templates[] = {
+   new Adapter("stack",          Adapter::Stack),
+   new Adapter("queue",          Adapter::Queue),
+   new Adapter("deque",          Adapter::Deque),
+   new Adapter("priority_queue", Adapter::PriorityQueue),
+   new Comparison("less"),
+   new Comparison("greater"),
+};
 
 Value Cout(cout), Cerr(cerr);
 Value Cin(cin);
@@ -54,6 +79,9 @@ Type *Type::get(TypeSpec *spec) {
          }
          T = T->instantiate(subtypes);
       }
+      if (spec->pointer) {
+         T = Pointer::mkpointer(T);
+      }
       if (spec->reference) {
          T = new Reference(T);
       }
@@ -81,35 +109,23 @@ Type *Type::mkref(Type *t) {
    return t->reference_type;
 }
 
-void *Reference::alloc(Value& x) const {
-   Value::Box *b = x._box;
-   b->count++;
-   return b;
-}
-
-void Reference::destroy(void *data) const {
-   Value::Box *b = (Value::Box*)data;
-   if (--(b->count) == 0) {
-      b->type->destroy(b->data);
-      delete b;
-   }
-}
-
 Value Reference::convert(Value init) {
    assert(init.type() == _subtype);
    return Value();
 }
 
+// References are "places": the Value points at the referenced Box
+// directly, so making one allocates nothing.
 Value Reference::mkref(Value& v) {
-   Value::Box *b = v._box;
-   v._box->count++;
-   return Value(Type::mkref(v._box->type), (void*)b);
+   if (v._place) {
+      return v;
+   }
+   return Value(v._box, true);
 }
 
 Value Reference::deref(const Value& v) {
-   if (v.is<Reference>()) {
-      Value::Box *b = (Value::Box*)v._box->data;
-      return Value(b);
+   if (v._place) {
+      return Value(v._box);
    } else {
       return v;
    }
@@ -171,6 +187,52 @@ Value Bool::convert(Value x) {
    return Value::null;
 }
 
+// Valor por defecto para cada tipo controlado por vector (o map)!
+static Value _default_value(Type *t) {
+   if (t->is<Int>()) {
+      return Value(0);
+   } else if (t->is<Bool>()) {
+      return Value(false);
+   } else if (t->is<Float>()) {
+      return Value(0.0f);
+   } else if (t->is<Double>()) {
+      return Value(0.0);
+   } else if (t->is<Char>()) {
+      return Value('\0');
+   } else {
+      return t->create();
+   }
+}
+
+// Lexicographic order of cells (vectors and arrays)
+static bool _cells_less(const vector<Value>& a, const vector<Value>& b) {
+   return lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), ValueLess());
+}
+
+static size_t _cells_hash(const vector<Value>& cells) {
+   size_t h = cells.size();
+   for (const Value& c : cells) {
+      h = h * 31 + c.hash();
+   }
+   return h;
+}
+
+bool Vector::less(void *a, void *b) const {
+   return _cells_less(cast(a), cast(b));
+}
+
+size_t Vector::hash(void *data) const {
+   return _cells_hash(cast(data));
+}
+
+bool Array::less(void *a, void *b) const {
+   return _cells_less(cast(a), cast(b));
+}
+
+size_t Array::hash(void *data) const {
+   return _cells_hash(cast(data));
+}
+
 Value Vector::convert(Value init) {
    //
    // To support C++11-style initialization of vectors, this method should
@@ -196,20 +258,7 @@ Value Vector::construct(const vector<Value>& args) {
    if (args.size() == 2) { // initialization
       init = Reference::deref(args[1]);
    } else {
-      // Valor por defecto para cada tipo controlado por vector!
-      if (_celltype->is<Int>()) {
-         init = Value(0);
-      } else if (_celltype->is<Bool>()) {
-         init = Value(false);
-      } else if (_celltype->is<Float>()) {
-         init = Value(0.0f);
-      } else if (_celltype->is<Double>()) {
-         init = Value(0.0);
-      } else if (_celltype->is<Char>()) {
-         init = Value('\0');
-      } else {
-         init = _celltype->create();
-      }
+      init = _default_value(_celltype);
    }
    for (int i = 0; i < sz; i++) {
       (*vec)[i] = init.clone();
@@ -217,6 +266,29 @@ Value Vector::construct(const vector<Value>& args) {
    return Value(this, vec);
 }
 
+bool Struct::less(void *a, void *b) const {
+   const SimpleTable<Value>& ta = cast(a);
+   const SimpleTable<Value>& tb = cast(b);
+   for (int i = 0; i < ta.size(); i++) {
+      if (ta[i].second.less(tb[i].second)) {
+         return true;
+      }
+      if (tb[i].second.less(ta[i].second)) {
+         return false;
+      }
+   }
+   return false;
+}
+
+size_t Struct::hash(void *data) const {
+   const SimpleTable<Value>& tab = cast(data);
+   size_t h = 0;
+   for (int i = 0; i < tab.size(); i++) {
+      h = h * 31 + tab[i].second.hash();
+   }
+   return h;
+}
+
 string Vector::to_json(void *data) const {
    ostringstream o;
    o << "[";
@@ -231,6 +303,14 @@ string Vector::to_json(void *data) const {
    return o.str();
 }
 
+Array *Array::mkarray(Type *celltype, int sz) {
+   Array *&array = _arrays[make_pair(celltype, sz)];
+   if (array == 0) {
+      array = new Array(celltype, sz);
+   }
+   return array;
+}
+
 Value Array::create() {
    vector<Value> *array = new vector<Value>(_sz);
    for (int i = 0; i < _sz; i++) {
@@ -267,6 +347,113 @@ Value Array::convert(Value init) {
    return Value(this, array);
 }
 
+// MultiArray
+
+MultiArray *MultiArray::mkarray(Type *celltype, const vector<int>& dims) {
+   MultiArray *&array = _arrays[make_pair(celltype, dims)];
+   if (array == 0) {
+      array = new MultiArray(celltype, dims);
+   }
+   return array;
+}
+
+string MultiArray::typestr() const {
+   string s = _celltype->typestr();
+   for (int i = 0; i < _dims.size(); i++) {
+      s += "[]";
+   }
+   return s;
+}
+
+Type *MultiArray::rowtype() const {
+   if (_dims.size() == 2) {
+      return Array::mkarray(_celltype, _dims[1]);
+   }
+   return mkarray(_celltype, vector<int>(_dims.begin() + 1, _dims.end()));
+}
+
+Value MultiArray::create() {
+   int ncells = 1;
+   for (int d : _dims) {
+      ncells *= d;
+   }
+   vector<Value> *cells = new vector<Value>(ncells);
+   for (int i = 0; i < ncells; i++) {
+      (*cells)[i] = _celltype->create();
+   }
+   return Value(this, cells);
+}
+
+// Puts a (nested) list of values in the cells of dimension k onwards
+static void _convert_cells(Value init, Type *celltype, const vector<int>& dims, int k, 
+                           vector<Value>& cells, int offset) {
+   if (!init.is<VectorValue>()) {
+      _error("Inicializas una tabla con algo que no es una lista de valores");
+   }
+   vector<Value>& elist = init.as<VectorValue>();
+   if (elist.size() > dims[k]) {
+      _error("Demasiados valores al inicializar la tabla");
+   }
+   int rowsize = 1;
+   for (int j = k + 1; j < dims.size(); j++) {
+      rowsize *= dims[j];
+   }
+   for (int i = 0; i < elist.size(); i++) {
+      if (k + 1 == dims.size()) {
+         cells[offset + i] = celltype->convert(elist[i]);
+      } else {
+         _convert_cells(elist[i], celltype, dims, k + 1, cells, offset + i * rowsize);
+      }
+   }
+}
+
+Value MultiArray::convert(Value init) {
+   assert(!init.is_null());
+   Value array = create();
+   _convert_cells(init, _celltype, _dims, 0, cast(array.data()), 0);
+   return array;
+}
+
+Value MultiArray::row(void *data, int i) const {
+   vector<Value>& cells = cast(data);
+   const int rowsize = cells.size() / _dims[0];
+   auto first = cells.begin() + i * rowsize;
+   return Value(rowtype(), new vector<Value>(first, first + rowsize));
+}
+
+bool MultiArray::less(void *a, void *b) const {
+   return _cells_less(cast(a), cast(b));
+}
+
+size_t MultiArray::hash(void *data) const {
+   return _cells_hash(cast(data));
+}
+
+// Nested lists, one per dimension from k onwards
+static void _cells_json(ostream& o, const vector<Value>& cells, const vector<int>& dims, 
+                        int k, int offset, int size) {
+   const int rowsize = size / dims[k];
+   o << "[";
+   for (int i = 0; i < dims[k]; i++) {
+      if (i > 0) {
+         o << ", ";
+      }
+      if (k + 1 == dims.size()) {
+         o << cells[offset + i].to_json();
+      } else {
+         _cells_json(o, cells, dims, k + 1, offset + i * rowsize, rowsize);
+      }
+   }
+   o << "]";
+}
+
+string MultiArray::to_json(void *data) const {
+   ostringstream o;
+   vector<Value>& cells = cast(data);
+   _cells_json(o, cells, _dims, 0, 0, cells.size());
+   return o.str();
+}
+
 Value Struct::create() {
    SimpleTable<Value> *tab = new SimpleTable<Value>();
    for (int i = 0; i < _fields.size(); i++) {
@@ -316,6 +503,9 @@ void *Struct::clone(void *data) const {
 string Function::typestr() const {
    ostringstream o;
    o << "func(";
+   if (_variadic and _param_types.empty()) {
+      o << "...";
+   }
    for (int i = 0; i < _param_types.size(); i++) {
       if (i > 0) {
          o << ",";
@@ -420,10 +610,83 @@ map<string, pair<std::function<Type *(Type *)>, Type::Method>> Vector::_methods
             return Reference::mkref(v->back());
          }
       }
+   }, {
+      "begin", {
+         [](Type *celltype) -> Function * {
+            return (new Function(Iterator::self));
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            vector<Value> *v = static_cast<vector<Value>*>(data);
+            return Iterator::self->mkvalue(v, 0);
+         }
+      }
+   }, {
+      "end", {
+         [](Type *celltype) -> Function * {
+            return (new Function(Iterator::self));
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            vector<Value> *v = static_cast<vector<Value>*>(data);
+            return Iterator::self->mkvalue(v, v->size());
+         }
+      }
    }
 };
 
+bool Iterator::get(const Value& v, IterValue& it) {
+   if (v.is<Iterator>()) {
+      it = v.as<Iterator>();
+      return true;
+   }
+   if (v.is<Array>()) {
+      it = IterValue(&v.as<Array>(), 0);
+      return true;
+   }
+   return false;
+}
+
 // String
+
+// Methods with optional parameters, or that take a string or a char, are
+// variadic and check their arguments here
+static void _nargs(const vector<Value>& args, int min, int max, string method) {
+   if (args.size() < min or args.size() > max) {
+      _error("Error en el número de argumentos al llamar a '" + method + "'");
+   }
+}
+
+static int _int_arg(const vector<Value>& args, int i, string method) {
+   Value v = Reference::deref(args[i]);
+   if (!v.is<Int>() or v.data() == 0) {
+      _error("El argumento " + to_string(i+1) + " de '" + method + "' debe ser un 'int'");
+   }
+   return v.as<Int>();
+}
+
+static string _str_arg(const vector<Value>& args, int i, string method) {
+   Value v = Reference::deref(args[i]);
+   if (v.is<String>() and v.data() != 0) {
+      return v.as<String>();
+   }
+   if (v.is<Char>() and v.data() != 0) {
+      return string(1, v.as<Char>());
+   }
+   _error("El argumento " + to_string(i+1) + " de '" + method + "' debe ser un 'string' o un 'char'");
+   return "";
+}
+
+static int _pos_arg(const string& s, const vector<Value>& args, int i, string method) {
+   int pos = _int_arg(args, i, method);
+   if (pos < 0 or pos > s.size()) {
+      _error("La posición " + to_string(pos) + " no existe en el string");
+   }
+   return pos;
+}
+
+static int _found(size_t pos) { // string::npos is -1
+   return (pos == string::npos ? -1 : int(pos));
+}
+
 map<string, pair<std::function<Type *()>, Type::Method>> String::_methods = {
    {
       "size", 
@@ -436,15 +699,187 @@ map<string, pair<std::function<Type *()>, Type::Method>> String::_methods = {
             return Value(int(s->size()));
          }
       }
+   }, {
+      "length", 
+      {
+         []() -> Type * {
+            return new Function(Int::self);
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            string *s = static_cast<string*>(data);
+            return Value(int(s->size()));
+         }
+      }
+   }, {
+      "empty", 
+      {
+         []() -> Type * {
+            return new Function(Bool::self);
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            string *s = static_cast<string*>(data);
+            return Value(s->empty());
+         }
+      }
+   }, {
+      "clear", 
+      {
+         []() -> Type * {
+            return new Function(0);
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            static_cast<string*>(data)->clear();
+            return Value::null;
+         }
+      }
+   }, {
+      "c_str", 
+      {
+         []() -> Type * {
+            return new Function(String::self);
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            return Value(*static_cast<string*>(data));
+         }
+      }
    }, {
       "substr",
+      {
+         // substr(pos) or substr(pos, len)
+         []() -> Type * {
+            return new Function(String::self, true);
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            string *s = static_cast<string*>(data);
+            _nargs(args, 1, 2, "substr");
+            int pos = _pos_arg(*s, args, 0, "substr");
+            int len = (args.size() == 2 ? _int_arg(args, 1, "substr") : -1);
+            return Value(s->substr(pos, len < 0 ? string::npos : len));
+         }
+      }
+   }, {
+      "find",
+      {
+         // find(str or char) or find(str or char, pos)
+         []() -> Type * {
+            return new Function(Int::self, true);
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            string *s = static_cast<string*>(data);
+            _nargs(args, 1, 2, "find");
+            int pos = (args.size() == 2 ? _int_arg(args, 1, "find") : 0);
+            return Value(_found(s->find(_str_arg(args, 0, "find"), pos)));
+         }
+      }
+   }, {
+      "rfind",
+      {
+         []() -> Type * {
+            return new Function(Int::self, true);
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            string *s = static_cast<string*>(data);
+            _nargs(args, 1, 2, "rfind");
+            size_t pos = (args.size() == 2 ? _int_arg(args, 1, "rfind") : string::npos);
+            return Value(_found(s->rfind(_str_arg(args, 0, "rfind"), pos)));
+         }
+      }
+   }, {
+      "push_back",
+      {
+         []() -> Type * {
+            return (new Function(0))->add_param(Char::self);
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            static_cast<string*>(data)->push_back(Reference::deref(args[0]).as<Char>());
+            return Value::null;
+         }
+      }
+   }, {
+      "pop_back",
       {
          []() -> Type * {
-            return (new Function(Int::self))->add_params(Int::self, Int::self);
+            return new Function(0);
          },
          [](void *data, const vector<Value>& args) -> Value {
             string *s = static_cast<string*>(data);
-            return Value(string(s->substr(args[0].as<Int>(), args[1].as<Int>())));
+            if (s->empty()) {
+               _error("El string está vacío");
+            }
+            s->pop_back();
+            return Value::null;
+         }
+      }
+   }, {
+      "insert",
+      {
+         // insert(pos, str or char)
+         []() -> Type * {
+            return new Function(0, true);
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            string *s = static_cast<string*>(data);
+            _nargs(args, 2, 2, "insert");
+            s->insert(_pos_arg(*s, args, 0, "insert"), _str_arg(args, 1, "insert"));
+            return Value::null;
+         }
+      }
+   }, {
+      "erase",
+      {
+         // erase(), erase(pos) or erase(pos, len)
+         []() -> Type * {
+            return new Function(0, true);
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            string *s = static_cast<string*>(data);
+            _nargs(args, 0, 2, "erase");
+            int pos = (args.size() > 0 ? _pos_arg(*s, args, 0, "erase") : 0);
+            int len = (args.size() > 1 ? _int_arg(args, 1, "erase") : -1);
+            s->erase(pos, len < 0 ? string::npos : len);
+            return Value::null;
+         }
+      }
+   }, {
+      "replace",
+      {
+         // replace(pos, len, str or char)
+         []() -> Type * {
+            return new Function(0, true);
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            string *s = static_cast<string*>(data);
+            _nargs(args, 3, 3, "replace");
+            int pos = _pos_arg(*s, args, 0, "replace");
+            int len = _int_arg(args, 1, "replace");
+            s->replace(pos, len < 0 ? string::npos : len, _str_arg(args, 2, "replace"));
+            return Value::null;
+         }
+      }
+   }, {
+      "compare",
+      {
+         []() -> Type * {
+            return (new Function(Int::self))->add_param(String::self);
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            int cmp = static_cast<string*>(data)->compare(Reference::deref(args[0]).as<String>());
+            return Value(cmp < 0 ? -1 : cmp > 0 ? 1 : 0);
+         }
+      }
+   }, {
+      "at",
+      {
+         []() -> Type * {
+            return (new Function(Char::self))->add_param(Int::self);
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            string *s = static_cast<string*>(data);
+            int i = Reference::deref(args[0]).as<Int>();
+            if (i < 0 or i >= s->size()) {
+               _error("La posición " + to_string(i) + " no existe en el string");
+            }
+            return Value((*s)[i]);
          }
       }
    }
@@ -462,3 +897,586 @@ string Vector::typestr() const {
       return std::string("vector<") + _celltype->typestr() + ">"; 
    }
 }
+
+// Map
+
+bool Map::is_key(Type *t) {
+   if (t->is<Int>() or t->is<Float>() or t->is<Double>() or
+       t->is<Char>() or t->is<Bool>() or t->is<String>() or t->is<Struct>()) {
+      return true;
+   }
+   const Vector *v = t->as<Vector>();
+   return v != 0 and v->celltype() != 0 and is_key(v->celltype());
+}
+
+// Wrong instantiations are types that don't exist (0)
+Type *Map::instantiate(vector<Type *>& subtypes) const {
+   if (subtypes.size() != (_set ? 1 : 2)) {
+      return 0;
+   }
+   for (Type *t : subtypes) {
+      if (t == 0) {
+         return 0;
+      }
+   }
+   if (!is_key(subtypes[0])) {
+      return 0;
+   }
+   return new Map(this, subtypes[0], (_set ? 0 : subtypes[1]));
+}
+
+string Map::typestr() const {
+   if (_keytype == 0) {
+      return _name;
+   }
+   string s = _name + "<" + _keytype->typestr();
+   if (_valtype != 0) {
+      s += "," + _valtype->typestr();
+   }
+   return s + ">";
+}
+
+bool Map::equals(void *a, void *b) const {
+   return cast(a).equals(&cast(b));
+}
+
+void *Map::clone(void *data) const {
+   return cast(data).clone();
+}
+
+string Map::to_json(void *data) const {
+   ostringstream o;
+   o << "[";
+   bool first = true;
+   cast(data).each([&](const Value& key, const Value& val) {
+      o << (first ? "" : ", ");
+      if (_set) {
+         o << key.to_json();
+      } else {
+         o << "[" << key.to_json() << ", " << val.to_json() << "]";
+      }
+      first = false;
+   });
+   o << "]";
+   return o.str();
+}
+
+Value Map::create() {
+   KeyTable *table = (_ordered ? (KeyTable*)new OrderedTable() : new HashTable());
+   return Value(this, table);
+}
+
+Value Map::convert(Value init) {
+   if (init.has_type(this)) {
+      return init.clone();
+   }
+   return Value::null;
+}
+
+Value Map::construct(const vector<Value>& args) {
+   if (args.size() == 1 and Reference::deref(args[0]).has_type(this)) {
+      return Reference::deref(args[0]).clone();
+   }
+   if (!args.empty()) {
+      _error("El tipo '" + typestr() + "' no tiene ese constructor");
+   }
+   return create();
+}
+
+Value& Map::index(void *data, const Value& key) const {
+   bool inserted;
+   Value& val = cast(data).insert(key, inserted);
+   if (inserted) {
+      val = _default_value(_valtype);
+   }
+   return val;
+}
+
+bool Map::get_method(string name, pair<Type*, Method>& result) const {
+   auto it = _methods.find(name);
+   if (it == _methods.end() or _keytype == 0) {
+      return false;
+   }
+   result.first = (it->second.first)(this);
+   result.second = it->second.second;
+   return true;
+}
+
+map<string, pair<std::function<Type *(const Map *)>, Type::Method>> Map::_methods = {
+   {
+      "size", {
+         [](const Map *m) -> Type * { 
+            return new Function(Int::self); 
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            return Value(Map::cast(data).size());
+         }
+      }
+   }, {
+      "empty", {
+         [](const Map *m) -> Type * { 
+            return new Function(Bool::self); 
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            return Value(Map::cast(data).size() == 0);
+         }
+      }
+   }, {
+      "clear", {
+         [](const Map *m) -> Type * { 
+            return new Function(0); 
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            KeyTable& table = Map::cast(data);
+            vector<Value> keys;
+            table.each([&keys](const Value& key, const Value&) { keys.push_back(key); });
+            for (const Value& key : keys) {
+               table.erase(key);
+            }
+            return Value::null;
+         }
+      }
+   }, {
+      "count", {
+         [](const Map *m) -> Type * { 
+            return (new Function(Int::self))->add_param(m->keytype()); 
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            return Value(Map::cast(data).find(Reference::deref(args[0])) != 0 ? 1 : 0);
+         }
+      }
+   }, {
+      "erase", {
+         [](const Map *m) -> Type * { 
+            return (new Function(Int::self))->add_param(m->keytype()); 
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            return Value(Map::cast(data).erase(Reference::deref(args[0])) ? 1 : 0);
+         }
+      }
+   }, {
+      "insert", {
+         // sets insert a key, maps a pair<K,V> (if the key is not there)
+         [](const Map *m) -> Type * { 
+            Type *param = m->keytype();
+            if (!m->is_set()) {
+               param = Pair::mkpair(m->keytype(), m->valtype());
+            }
+            return (new Function(0))->add_param(param);
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            Value arg = Reference::deref(args[0]);
+            bool inserted;
+            if (!arg.is<Struct>()) {
+               Map::cast(data).insert(arg, inserted);
+               return Value::null;
+            }
+            Value first, second;
+            arg.as<Struct>().get("first", first);
+            arg.as<Struct>().get("second", second);
+            Value& val = Map::cast(data).insert(first, inserted);
+            if (inserted) {
+               val = second.clone();
+            }
+            return Value::null;
+         }
+      }
+   }, {
+      "find", {
+         [](const Map *m) -> Type * { 
+            return (new Function(KeyIterator::self))->add_param(m->keytype()); 
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            KeyTable *table = static_cast<KeyTable*>(data);
+            Value key = Reference::deref(args[0]);
+            return KeyIterator::self->mkvalue(table, table->find(key) ? key : Value::null);
+         }
+      }
+   }, {
+      "end", {
+         [](const Map *m) -> Type * { 
+            return new Function(KeyIterator::self); 
+         },
+         [](void *data, const vector<Value>& args) -> Value {
+            return KeyIterator::self->mkvalue(static_cast<KeyTable*>(data), Value::null);
+         }
+      }
+   }
+};
+
+// Pair
+
+Struct *Pair::mkpair(Type *first, Type *second) {
+   Struct *&pair = _pairs[make_pair(first, second)];
+   if (pair == 0) {
+      pair = new Struct("pair<" + first->typestr() + "," + second->typestr() + ">");
+      pair->add_field("first", first);
+      pair->add_field("second", second);
+   }
+   return pair;
+}
+
+Type *Pair::instantiate(vector<Type *>& subtypes) const {
+   if (subtypes.size() != 2 or subtypes[0] == 0 or subtypes[1] == 0) {
+      return 0;
+   }
+   return mkpair(subtypes[0], subtypes[1]);
+}
+
+// Adapter
+
+Type *Adapter::instantiate(vector<Type *>& subtypes) const {
+   if (subtypes.empty() or subtypes[0] == 0) {
+      return 0;
+   }
+   Type *celltype = subtypes[0];
+   bool greater = false;
+   if (_kind == PriorityQueue and subtypes.size() == 3) {
+      // priority_queue<T, vector<T>, less<T> or greater<T>>
+      const Vector *v = (subtypes[1] ? subtypes[1]->as<Vector>() : 0);
+      const Comparison *c = (subtypes[2] ? subtypes[2]->as<Comparison>() : 0);
+      if (v == 0 or v->celltype() != celltype or c == 0 or c->type() != celltype) {
+         return 0;
+      }
+      greater = c->greater();
+   } else if (subtypes.size() != 1) {
+      return 0;
+   }
+   return new Adapter(this, celltype, greater);
+}
+
+string Adapter::typestr() const {
+   if (_celltype == 0) {
+      return _name;
+   }
+   string s = _name + "<" + _celltype->typestr();
+   if (_greater) {
+      s += ",vector<" + _celltype->typestr() + ">,greater<" + _celltype->typestr() + ">";
+   }
+   return s + ">";
+}
+
+Value Adapter::create() {
+   if (_kind == PriorityQueue) {
+      return Value(this, new Heap(_greater));
+   }
+   return Value(this, new RingBuffer());
+}
+
+Value Adapter::convert(Value init) {
+   if (init.has_type(this)) {
+      return init.clone();
+   }
+   return Value::null;
+}
+
+Value Adapter::construct(const vector<Value>& args) {
+   if (args.size() == 1 and Reference::deref(args[0]).has_type(this)) {
+      return Reference::deref(args[0]).clone();
+   }
+   if (!args.empty()) {
+      _error("El tipo '" + typestr() + "' no tiene ese constructor");
+   }
+   return create();
+}
+
+void Adapter::destroy(void *data) const {
+   if (_kind == PriorityQueue) {
+      delete static_cast<Heap*>(data);
+   } else {
+      delete static_cast<RingBuffer*>(data);
+   }
+}
+
+// The cells from front to back (in heap order for a priority_queue)
+void Adapter::cells(void *data, vector<Value>& cells) const {
+   if (_kind == PriorityQueue) {
+      cells = static_cast<Heap*>(data)->cells();
+      return;
+   }
+   RingBuffer *ring = static_cast<RingBuffer*>(data);
+   for (int i = 0; i < ring->size(); i++) {
+      cells.push_back((*ring)[i]);
+   }
+}
+
+bool Adapter::equals(void *a, void *b) const {
+   vector<Value> ca, cb;
+   cells(a, ca);
+   cells(b, cb);
+   if (ca.size() != cb.size()) {
+      return false;
+   }
+   for (int i = 0; i < ca.size(); i++) {
+      if (!ca[i].equals(cb[i])) {
+         return false;
+      }
+   }
+   return true;
+}
+
+void *Adapter::clone(void *data) const {
+   vector<Value> from;
+   cells(data, from);
+   if (_kind == PriorityQueue) {
+      Heap *heap = new Heap(_greater);
+      for (const Value& v : from) {
+         heap->push(v.clone()); // (already in heap order)
+      }
+      return heap;
+   }
+   RingBuffer *ring = new RingBuffer();
+   for (const Value& v : from) {
+      ring->push_back(v.clone());
+   }
+   return ring;
+}
+
+string Adapter::to_json(void *data) const {
+   vector<Value> vals;
+   cells(data, vals);
+   ostringstream o;
+   o << "[";
+   for (int i = 0; i < vals.size(); i++) {
+      o << (i > 0 ? ", " : "") << vals[i].to_json();
+   }
+   o << "]";
+   return o.str();
+}
+
+bool Adapter::get_method(string name, pair<Type*, Method>& result) const {
+   // The methods of stack and queue are those of the RingBuffer under other names
+   static map<string, string> names[] = {
+      { {"push", "push_back"}, {"pop", "pop_back"},  {"top", "back"},  
+        {"size", "size"}, {"empty", "empty"} },
+      { {"push", "push_back"}, {"pop", "pop_front"}, {"front", "front"}, {"back", "back"}, 
+        {"size", "size"}, {"empty", "empty"} },
+   };
+   if (_celltype == 0) {
+      return false;
+   }
+   const MethodMap& methods = (_kind == PriorityQueue ? _heap_methods : _ring_methods);
+   if (_kind == Stack or _kind == Queue) {
+      auto n = names[_kind].find(name);
+      if (n == names[_kind].end()) {
+         return false;
+      }
+      name = n->second;
+   }
+   auto it = methods.find(name);
+   if (it == methods.end()) {
+      return false;
+   }
+   result.first = (it->second.first)(_celltype);
+   result.second = it->second.second;
+   return true;
+}
+
+static RingBuffer& _ring(void *data) {
+   return *static_cast<RingBuffer*>(data);
+}
+
+static RingBuffer& _nonempty_ring(void *data) {
+   RingBuffer& ring = _ring(data);
+   if (ring.size() == 0) {
+      _error("El contenedor está vacío");
+   }
+   return ring;
+}
+
+static Heap& _heap(void *data) {
+   return *static_cast<Heap*>(data);
+}
+
+static Heap& _nonempty_heap(void *data) {
+   Heap& heap = _heap(data);
+   if (heap.size() == 0) {
+      _error("La cola de prioridad está vacía");
+   }
+   return heap;
+}
+
+Adapter::MethodMap Adapter::_ring_methods = {
+   {
+      "size", {
+         [](Type *celltype) -> Type * { return new Function(Int::self); },
+         [](void *data, const vector<Value>& args) -> Value {
+            return Value(_ring(data).size());
+         }
+      }
+   }, {
+      "empty", {
+         [](Type *celltype) -> Type * { return new Function(Bool::self); },
+         [](void *data, const vector<Value>& args) -> Value {
+            return Value(_ring(data).size() == 0);
+         }
+      }
+   }, {
+      "clear", {
+         [](Type *celltype) -> Type * { return new Function(0); },
+         [](void *data, const vector<Value>& args) -> Value {
+            _ring(data).clear();
+            return Value::null;
+         }
+      }
+   }, {
+      "push_back", {
+         [](Type *celltype) -> Type * { return (new Function(0))->add_param(celltype); },
+         [](void *data, const vector<Value>& args) -> Value {
+            _ring(data).push_back(Reference::deref(args[0]).clone());
+            return Value::null;
+         }
+      }
+   }, {
+      "push_front", {
+         [](Type *celltype) -> Type * { return (new Function(0))->add_param(celltype); },
+         [](void *data, const vector<Value>& args) -> Value {
+            _ring(data).push_front(Reference::deref(args[0]).clone());
+            return Value::null;
+         }
+      }
+   }, {
+      "pop_back", {
+         [](Type *celltype) -> Type * { return new Function(0); },
+         [](void *data, const vector<Value>& args) -> Value {
+            _nonempty_ring(data).pop_back();
+            return Value::null;
+         }
+      }
+   }, {
+      "pop_front", {
+         [](Type *celltype) -> Type * { return new Function(0); },
+         [](void *data, const vector<Value>& args) -> Value {
+            _nonempty_ring(data).pop_front();
+            return Value::null;
+         }
+      }
+   }, {
+      "front", {
+         [](Type *celltype) -> Type * { return new Function(celltype); },
+         [](void *data, const vector<Value>& args) -> Value {
+            return Reference::mkref(_nonempty_ring(data).front());
+         }
+      }
+   }, {
+      "back", {
+         [](Type *celltype) -> Type * { return new Function(celltype); },
+         [](void *data, const vector<Value>& args) -> Value {
+            return Reference::mkref(_nonempty_ring(data).back());
+         }
+      }
+   }
+};
+
+Adapter::MethodMap Adapter::_heap_methods = {
+   {
+      "size", {
+         [](Type *celltype) -> Type * { return new Function(Int::self); },
+         [](void *data, const vector<Value>& args) -> Value {
+            return Value(_heap(data).size());
+         }
+      }
+   }, {
+      "empty", {
+         [](Type *celltype) -> Type * { return new Function(Bool::self); },
+         [](void *data, const vector<Value>& args) -> Value {
+            return Value(_heap(data).size() == 0);
+         }
+      }
+   }, {
+      "push", {
+         [](Type *celltype) -> Type * { return (new Function(0))->add_param(celltype); },
+         [](void *data, const vector<Value>& args) -> Value {
+            _heap(data).push(Reference::deref(args[0]).clone());
+            return Value::null;
+         }
+      }
+   }, {
+      "pop", {
+         [](Type *celltype) -> Type * { return new Function(0); },
+         [](void *data, const vector<Value>& args) -> Value {
+            _nonempty_heap(data).pop();
+            return Value::null;
+         }
+      }
+   }, {
+      "top", {
+         // a copy, since changing the top would break the heap
+         [](Type *celltype) -> Type * { return new Function(celltype); },
+         [](void *data, const vector<Value>& args) -> Value {
+            return _nonempty_heap(data).top().clone();
+         }
+      }
+   }
+};
+
+// Pointer
+
+Pointer *Pointer::mkpointer(Type *pointee) {
+   Pointer *&pointer = _pointers[pointee];
+   if (pointer == 0) {
+      pointer = new Pointer(pointee);
+   }
+   return pointer;
+}
+
+string Pointer::typestr() const {
+   return (_pointee == 0 ? "nullptr_t" : _pointee->typestr() + "*");
+}
+
+// nullptr converts to any pointer
+Value Pointer::convert(Value init) {
+   init = Reference::deref(init);
+   if (init.has_type(this)) {
+      return init.clone();
+   }
+   if (init.has_type(null)) {
+      return create();
+   }
+   if (init.is<Int>() and init.data() != 0 and init.as<Int>() == 0) {
+      return create(); // 0 as the null pointer constant
+   }
+   return Value::null;
+}
+
+bool Pointer::less(void *a, void *b) const {
+   const PtrValue& pa = cast(a), &pb = cast(b);
+   if (pa.block != pb.block) {
+      return pa.block < pb.block;
+   }
+   if (pa.block < 0) {
+      return pa.target.data() < pb.target.data();
+   }
+   return pa.pos < pb.pos;
+}
+
+size_t Pointer::hash(void *data) const {
+   const PtrValue& p = cast(data);
+   return (p.block < 0 ? std::hash<void*>()(p.target.data()) : p.block * 31 + p.pos);
+}
+
+string Pointer::to_json(void *data) const {
+   const PtrValue& p = cast(data);
+   ostringstream o;
+   if (p.is_null()) {
+      o << "null";
+   } else if (p.block < 0) {
+      o << "{\"ptr\":\"&\"}";
+   } else {
+      o << "{\"ptr\":\"new\",\"block\":" << p.block << ",\"pos\":" << p.pos << "}";
+   }
+   return o.str();
+}
+
+// Comparison
+
+string Comparison::typestr() const {
+   return (_type == 0 ? _name : _name + "<" + _type->typestr() + ">");
+}
+
+Type *Comparison::instantiate(vector<Type *>& subtypes) const {
+   if (subtypes.size() != 1 or subtypes[0] == 0) {
+      return 0;
+   }
+   return new Comparison(_name, subtypes[0]);
+}
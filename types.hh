@@ -3,9 +3,12 @@
 
 #include <vector>
 #include <map>
+#include <functional>
 #include <sstream>
 #include "ast.hh"
 #include "value.hh"
+#include "keytable.hh"
+#include "containers.hh"
 
 using std::string;
 
@@ -20,7 +23,10 @@ class Type {
    //      void *alloc(T x) = a different method for every Type
    virtual void   destroy(void *data) const                 { assert(false); }
    virtual bool   equals(void *data_a, void *data_b)  const { assert(false); }
+   virtual bool   less(void *data_a, void *data_b)    const { assert(false); }
+   virtual size_t hash(void *data)                    const { assert(false); }
    virtual void  *clone(void *data)                   const { assert(false); }
+   virtual void  *assign(void *to, void *from)        const { destroy(to); return clone(from); }
    virtual void   write(std::ostream& o, void *data)  const { assert(false); }
    virtual void  *read(std::istream& i, void *data)   const { assert(false); }
    virtual string to_json(void *data)                 const { assert(false); }
@@ -82,6 +88,7 @@ public:
    }
 
    void *alloc(T x) const { 
+      Value::allocations++;
       return new T(x); 
    }
    void destroy(void *data) const {
@@ -100,6 +107,7 @@ public:
       if (data == 0) {
          return 0;
       }
+      Value::allocations++;
       return new T(*static_cast<T*>(data));
    }
    Value create() { 
@@ -125,8 +133,23 @@ public:
       assert(false); // Basic types are not "constructed"
       return Value::null;
    }
+   bool less(void *a, void *b) const {
+      return (*static_cast<T*>(a)) < (*static_cast<T*>(b));
+   }
+   size_t hash(void *data) const {
+      return std::hash<T>()(*static_cast<T*>(data));
+   }
+   void *assign(void *to, void *from) const { // overwrite in place
+      if (to == 0 or from == 0) {
+         this->destroy(to);
+         return this->clone(from);
+      }
+      *static_cast<T*>(to) = *static_cast<T*>(from);
+      return to;
+   }
    void *read(std::istream& i, void *data) const {
       if (data == 0) {
+         Value::allocations++;
          data = new T;
       }
       i >> (*static_cast<T*>(data));
@@ -148,10 +171,8 @@ public:
 
    std::string  typestr()           const { return _subtype->typestr() + "&"; }
            int  properties()        const { return Basic; }
+    const Type *subtype()           const { return _subtype; }
 
-          void *alloc(Value& x)     const;
-          void  destroy(void *data) const;
-   
          Value  convert(Value init);
 
   static Value  mkref(Value& v);  // create a reference to a value
@@ -240,8 +261,9 @@ struct FuncValue {
 class Function : public BaseType<FuncValue> {
    Type *_return_type;
    std::vector<Type*> _param_types;
+   bool _variadic; // arguments are checked by the (builtin) function itself
 public:
-   Function(Type *t) : _return_type(t) {}
+   Function(Type *t, bool variadic = false) : _return_type(t), _variadic(variadic) {}
    Function *add_param(Type *t)  { _param_types.push_back(t); return this; }
    Function *add_params(Type *t1, Type *t2)  { 
       _param_types.push_back(t1);
@@ -258,6 +280,7 @@ public:
    Type *param(int i)      const { return _param_types[i]; }
    Type *return_type()     const { return _return_type; }
    bool is_void()          const { return _return_type == 0; }
+   bool is_variadic()      const { return _variadic; }
 
    int properties() const { return Internal; }
    std::string typestr() const;
@@ -280,6 +303,8 @@ public:
    Value create();
    Value convert(Value init);
    void *clone(void *data) const;
+   bool  less(void *a, void *b) const;
+   size_t hash(void *data) const;
 
    std::string typestr() const { return _name; }
    std::string to_json(void *data) const {
@@ -292,12 +317,46 @@ public:
 class Array : public BaseType<std::vector<Value>> {
    Type *_celltype;
    int _sz;
+
+   static std::map<std::pair<Type*, int>, Array*> _arrays;
 public:
                 Array(Type *celltype, int sz) : _celltype(celltype), _sz(sz) {}
            int  properties() const { return Basic; }
    std::string  typestr()    const { return _celltype->typestr() + "[]"; }
          Value  create();
          Value  convert(Value init);
+          Type *celltype()   const { return _celltype; }
+          bool  less(void *a, void *b) const;
+        size_t  hash(void *data) const;
+
+  static Array *mkarray(Type *celltype, int sz); // one Array type per (celltype, size)
+};
+
+// A table of more than one dimension ('int a[3][4]'): all cells in one
+// vector, in row-major order. Indexing it with fewer indices gives a view
+// of a row, which shares the cells.
+class MultiArray : public BaseType<std::vector<Value>> {
+   Type *_celltype;
+   std::vector<int> _dims;
+
+   static std::map<std::pair<Type*, std::vector<int>>, MultiArray*> _arrays;
+public:
+                MultiArray(Type *celltype, const std::vector<int>& dims) 
+                   : _celltype(celltype), _dims(dims) {}
+           int  properties() const { return Basic; }
+   std::string  typestr()    const;
+         Value  create();
+         Value  convert(Value init);
+          Type *celltype()   const { return _celltype; }
+           int  rank()       const { return _dims.size(); }
+           int  dim(int k)   const { return _dims[k]; }
+          Type *rowtype()    const;
+         Value  row(void *data, int i) const;
+          bool  less(void *a, void *b) const;
+        size_t  hash(void *data) const;
+   std::string  to_json(void *data) const;
+
+  static MultiArray *mkarray(Type *celltype, const std::vector<int>& dims);
 };
 
 class Vector : public BaseType<std::vector<Value>> {
@@ -319,6 +378,8 @@ public:
 
    std::string typestr() const;
    bool get_method(std::string name, std::pair<Type*, Method>& method) const;
+   bool  less(void *a, void *b) const;
+   size_t hash(void *data) const;
 
    std::string to_json(void *data) const;
 
@@ -341,6 +402,214 @@ public:
    std::string typestr() const { return "vector<?>"; }
 };
 
+// A position in the cells of a vector or an array
+struct IterValue {
+   std::vector<Value> *cells;
+   int pos;
+   IterValue(std::vector<Value> *c = 0, int p = 0) : cells(c), pos(p) {}
+   bool operator==(const IterValue& i) const { return cells == i.cells and pos == i.pos; }
+};
+
+class Iterator : public BaseType<IterValue> {
+public:
+   int   properties() const { return Internal; }
+   Value mkvalue(std::vector<Value> *cells, int pos) { 
+      return Value(this, new IterValue(cells, pos)); 
+   }
+   std::string typestr() const { return "iterator"; }
+
+   static bool get(const Value& v, IterValue& it); // an array is its first cell
+   static Iterator *self;
+
+   typedef IterValue cpp_type;
+};
+
+// A position in a map or set (the key, null at the end)
+struct KeyIterValue {
+   KeyTable *table;
+   Value key;
+   KeyIterValue(KeyTable *t, Value k) : table(t), key(k) {}
+   bool operator==(const KeyIterValue& i) const { 
+      return table == i.table and 
+         (key.is_null() ? i.key.is_null() : !i.key.is_null() and key.equals(i.key));
+   }
+};
+
+class KeyIterator : public BaseType<KeyIterValue> {
+public:
+   int   properties() const { return Internal; }
+   Value mkvalue(KeyTable *table, Value key) { return Value(this, new KeyIterValue(table, key)); }
+   std::string typestr() const { return "iterator"; }
+
+   static KeyIterator *self;
+   typedef KeyIterValue cpp_type;
+};
+
+// A pointer: a cell in a block of the Arena (if block >= 0, and only 
+// while the block keeps the same tag), or else a variable (the target)
+// or nothing (nullptr)
+struct PtrValue {
+   int      block, pos;
+   unsigned tag;
+   Value    target;
+
+   PtrValue() : block(-1), pos(0), tag(0) {}
+   bool is_null() const { return block < 0 and target.is_null(); }
+   bool operator==(const PtrValue& p) const { 
+      return block == p.block and pos == p.pos and tag == p.tag and target == p.target;
+   }
+};
+
+class Pointer : public BaseType<PtrValue> {
+   Type *_pointee; // _pointee == 0 means it's the type of nullptr
+
+   static std::map<Type*, Pointer*> _pointers;
+public:
+   Pointer(Type *pointee) : _pointee(pointee) {}
+
+   int   properties() const { return Basic; }
+   Type *pointee()    const { return _pointee; }
+   Value create()           { return Value(this, new PtrValue()); }
+   Value convert(Value init);
+   Value mkvalue(const PtrValue& p) { return Value(this, new PtrValue(p)); }
+   bool  less(void *a, void *b) const;
+   size_t hash(void *data) const;
+
+   std::string typestr() const;
+   std::string to_json(void *data) const;
+
+   static Pointer *mkpointer(Type *pointee); // one Pointer type per pointee
+   static Pointer *null;
+};
+
+// map<K,V>, set<K>, unordered_map<K,V> and unordered_set<K>: the ordered
+// ones keep an OrderedTable and the unordered ones a HashTable.
+class Map : public Type {
+   std::string _name;
+   bool        _ordered, _set;
+   Type       *_keytype, *_valtype; // _keytype == 0 means it's the template
+
+   Map(const Map *tmpl, Type *k, Type *v) 
+      : _name(tmpl->_name), _ordered(tmpl->_ordered), _set(tmpl->_set), 
+        _keytype(k), _valtype(v) {}
+
+   void   destroy(void *data)         const { delete static_cast<KeyTable*>(data); }
+   bool   equals(void *a, void *b)    const;
+   void  *clone(void *data)           const;
+   std::string to_json(void *data)    const;
+
+public:
+   Map(std::string name, bool ordered, bool set)
+      : _name(name), _ordered(ordered), _set(set), _keytype(0), _valtype(0) { 
+      Type::register_type(name, this); 
+   }
+
+   typedef KeyTable cpp_type;
+   static KeyTable& cast(void *data) { return *static_cast<KeyTable*>(data); }
+
+   Type *instantiate(std::vector<Type*>& args) const;
+
+   Type *keytype() const { return _keytype; }
+   Type *valtype() const { return _valtype; }
+   bool  is_set()  const { return _set; }
+
+   int   properties() const { return Template | Emulated; }
+   Value create();
+   Value convert(Value init);
+   Value construct(const std::vector<Value>& args);
+
+   Value& index(void *data, const Value& key) const; // 'm[key]', which inserts key if missing
+
+   std::string typestr() const;
+   bool get_method(std::string name, std::pair<Type*, Method>& method) const;
+
+   static bool is_key(Type *t); // whether values of t can be keys
+
+private:
+   static std::map<
+      std::string, 
+      std::pair<std::function<Type *(const Map *)>, Method>
+   > _methods;
+};
+
+// stack<T>, queue<T> and deque<T> keep a RingBuffer, and priority_queue<T>
+// (or priority_queue<T, vector<T>, greater<T>>) a Heap.
+class Adapter : public Type {
+public:
+   enum Kind { Stack, Queue, Deque, PriorityQueue };
+
+private:
+   std::string _name;
+   Kind        _kind;
+   Type       *_celltype; // _celltype == 0 means it's the template
+   bool        _greater;
+
+   Adapter(const Adapter *tmpl, Type *celltype, bool greater)
+      : _name(tmpl->_name), _kind(tmpl->_kind), _celltype(celltype), _greater(greater) {}
+
+   void   destroy(void *data)         const;
+   bool   equals(void *a, void *b)    const;
+   void  *clone(void *data)           const;
+   std::string to_json(void *data)    const;
+
+   void   cells(void *data, std::vector<Value>& cells) const;
+
+public:
+   Adapter(std::string name, Kind kind)
+      : _name(name), _kind(kind), _celltype(0), _greater(false) {
+      Type::register_type(name, this);
+   }
+
+   Type *instantiate(std::vector<Type*>& args) const;
+
+   Type *celltype() const { return _celltype; }
+   Kind  kind()     const { return _kind; }
+
+   int   properties() const { return Template | Emulated; }
+   Value create();
+   Value convert(Value init);
+   Value construct(const std::vector<Value>& args);
+
+   std::string typestr() const;
+   bool get_method(std::string name, std::pair<Type*, Method>& method) const;
+
+private:
+   typedef std::map<
+      std::string, 
+      std::pair<std::function<Type *(Type *)>, Method>
+   > MethodMap;
+   static MethodMap _ring_methods, _heap_methods;
+};
+
+// less<T> and greater<T>, only as the comparison of a priority_queue
+class Comparison : public Type {
+   std::string _name;
+   Type       *_type;
+   Comparison(std::string name, Type *t) : _name(name), _type(t) {}
+public:
+   Comparison(std::string name) : _name(name), _type(0) { Type::register_type(name, this); }
+
+   std::string typestr()    const;
+           int properties() const { return Template | Internal; }
+          Type *instantiate(std::vector<Type*>& args) const;
+          Type *type()       const { return _type; }
+          bool  greater()    const { return _name == "greater"; }
+};
+
+// pair<A,B> is a struct with fields 'first' and 'second'
+class Pair : public Type {
+   static std::map<std::pair<Type*, Type*>, Struct*> _pairs;
+public:
+   Pair() { Type::register_type("pair", this); }
+
+   std::string typestr()    const { return "pair"; }
+           int properties() const { return Template | Emulated; }
+          Type *instantiate(std::vector<Type*>& args) const;
+
+   static Struct *mkpair(Type *first, Type *second); // one Struct per (first, second)
+   static Pair *self;
+};
+
 class Ostream : public Type {
    void destroy(void *data)  const {}
 public:
@@ -374,13 +643,13 @@ public:
 
 template<typename T>
 bool Value::is() const {
-   return !is_null() and (typeid(*(_box->type)) == typeid(T)); 
+   return !is_null() and (typeid(*type()) == typeid(T)); 
 }
 
 template<typename T>
 typename T::cpp_type& Value::as() const {
    assert(is<T>() and _box);
-   return T::cast(_box->data);
+   return T::cast(data());
 }
 
 #endif
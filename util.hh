@@ -1,33 +1,36 @@
 #ifndef UTIL_HH
 #define UTIL_HH
 
+#include <vector>
+#include "symbol.hh"
+
 template<typename T>
 class SimpleTable {
 protected:
    struct Item {
-      std::pair<std::string, T> _data; // name + data
+      std::pair<Symbol, T> _data; // name + data
       bool                      _hidden;
 
-      Item(std::string n, T d, bool h = false) : _data(n, d), _hidden(h) {}
+      Item(Symbol n, T d, bool h = false) : _data(n, d), _hidden(h) {}
 
       bool operator==(const Item& i) const {
          return _data == i._data and _hidden == i._hidden; // hidden?
       }
 
-      std::string name() const { return _data.first; }
+      Symbol name() const { return _data.first; }
       T data() const { return _data.second; }
    };
 
    std::vector<Item> tab;
-   Item *_get(std::string name);
+   Item *_get(Symbol name);
    
 public:
    int size() const { return tab.size(); }
-   const std::pair<std::string, T>& operator[](int i) const { 
+   const std::pair<Symbol, T>& operator[](int i) const { 
       return tab[i]._data; 
    }
 
-   void set(std::string name, T data, bool hidden = false) {
+   void set(Symbol name, T data, bool hidden = false) {
       Item *i = _get(name);
       if (i == 0) {
          tab.push_back(Item(name, data, hidden));
@@ -36,7 +39,7 @@ public:
       }
    }
 
-   bool get(std::string name, T& res) {
+   bool get(Symbol name, T& res) {
       Item *i = _get(name);
       if (i) {
          res = i->_data.second;
@@ -50,7 +53,7 @@ public:
 };
 
 template<typename T>
-typename SimpleTable<T>::Item *SimpleTable<T>::_get(std::string name) {
+typename SimpleTable<T>::Item *SimpleTable<T>::_get(Symbol name) {
    for (int i = 0; i < tab.size(); i++) {
       if (tab[i]._data.first == name) {
          return &tab[i];
@@ -10,6 +10,7 @@ using namespace std;
 #include "types.hh"
 
 Value Value::null;
+long  Value::allocations = 0;
 
 void Value::_attach(Box *b) {
    assert(b != 0);
@@ -24,20 +25,24 @@ void Value::_detach(Box *b) {
    }
 }
 
-Value::Value(Type *t, void *d) {
+Value::Value(Type *t, void *d) : _place(false) {
    assert(t != 0);
    _attach(new Box(t, d));
 }
 
-Value::Value(Box *box) { 
+Value::Value(Box *box, bool place) : _place(place) { 
    _attach(box); 
 }
 
+Type *Value::_place_type() const {
+   return Type::mkref(_box->type);
+}
+
 Value::~Value() {
    _detach(_box);
 }
 
-Value::Value(const Value& v) {
+Value::Value(const Value& v) : _place(v._place) {
    if (v.is_null()) {
       _box = 0;
    } else {
@@ -47,6 +52,7 @@ Value::Value(const Value& v) {
 
 const Value& Value::operator=(const Value& v) {
    _detach(_box);
+   _place = v._place;
    if (v.is_null()) {
       _box = 0;
    } else {
@@ -71,8 +77,11 @@ bool Value::assign(const Value& v) {
    if (!same_type_as(v)) {
       return false;
    }
-   _box->type->destroy(_box->data);
-   _box->data = _box->type->clone(v._box->data);
+   assert(!_place and !v._place);
+   if (_box->data == v._box->data) {
+      return true; // (self-assignment: 'assign' destroys before it copies)
+   }
+   _box->data = _box->type->assign(_box->data, v._box->data);
    return true;
 }
 
@@ -93,28 +102,50 @@ bool Value::equals(const Value& v) const {
    if (!same_type_as(v)) {
       return false;
    }
-   return _box->type->equals(_box->data, v._box->data);
+   return type()->equals(data(), v.data());
+}
+
+// Values are ordered by type first (any fixed order will do), then by
+// data, with the uninitialized ones before the rest.
+bool Value::less(const Value& v) const {
+   if (is_null() or v.is_null()) {
+      return is_null() and !v.is_null();
+   }
+   if (!same_type_as(v)) {
+      return type() < v.type();
+   }
+   if (data() == 0 or v.data() == 0) {
+      return data() == 0 and v.data() != 0;
+   }
+   return type()->less(data(), v.data());
+}
+
+size_t Value::hash() const {
+   if (is_null() or data() == 0) {
+      return 0;
+   }
+   return type()->hash(data());
 }
 
 string Value::type_name() const {
    assert(_box != 0);
-   return _box->type->typestr();
+   return type()->typestr();
 }
 
 string Value::to_json() const {
    assert(!is_null());
-   return _box->type->to_json(_box->data);
+   return type()->to_json(data());
 }
 
-Value::Value(int x)         { _attach(new Box(Int::self,    Int::self->alloc(x))); }
-Value::Value(char x)        { _attach(new Box(Char::self,   Char::self->alloc(x))); }
-Value::Value(bool x)        { _attach(new Box(Bool::self,   Bool::self->alloc(x))); }
-Value::Value(float x)       { _attach(new Box(Float::self,  Float::self->alloc(x))); }
-Value::Value(double x)      { _attach(new Box(Double::self, Double::self->alloc(x))); }
-Value::Value(string x)      { _attach(new Box(String::self, String::self->alloc(x))); }
-Value::Value(ostream& o)    { _attach(new Box(Ostream::self, &o)); }
-Value::Value(istream& i)    { _attach(new Box(Istream::self, &i)); }
-Value::Value(const char *x) { _attach(new Box(String::self, String::self->alloc(string(x)))); }
+Value::Value(int x) : _place(false) { _attach(new Box(Int::self,    Int::self->alloc(x))); }
+Value::Value(char x) : _place(false) { _attach(new Box(Char::self,   Char::self->alloc(x))); }
+Value::Value(bool x) : _place(false) { _attach(new Box(Bool::self,   Bool::self->alloc(x))); }
+Value::Value(float x) : _place(false) { _attach(new Box(Float::self,  Float::self->alloc(x))); }
+Value::Value(double x) : _place(false) { _attach(new Box(Double::self, Double::self->alloc(x))); }
+Value::Value(string x) : _place(false) { _attach(new Box(String::self, String::self->alloc(x))); }
+Value::Value(ostream& o) : _place(false) { _attach(new Box(Ostream::self, &o)); }
+Value::Value(istream& i) : _place(false) { _attach(new Box(Istream::self, &i)); }
+Value::Value(const char *x) : _place(false) { _attach(new Box(String::self, String::self->alloc(string(x)))); }
 
 std::ostream& operator<<(std::ostream& o, const Value& v) {
    v.write(o);
@@ -12,18 +12,20 @@ class Value { // new value
       Type *type;
       void *data;
 
-      Box() : count(0), type(0), data(0) {}
-      Box(Type *t, void *d) : count(0), type(t), data(d) {}
+      Box() : count(0), type(0), data(0) { allocations++; }
+      Box(Type *t, void *d) : count(0), type(t), data(d) { allocations++; }
    };
    Box *_box;
+   bool _place; // this Value is a Reference to _box (a "place", not a Box)
 
    void _detach(Box *b);
    void _attach(Box *b);
+   Type *_place_type() const; // (a reference to the box's type)
 
-   explicit Value(Box *box);
+   explicit Value(Box *box, bool place = false);
 
 public:
-   explicit Value() : _box(0) {}
+   explicit Value() : _box(0), _place(false) {}
    explicit Value(Type *t, void *d);
    Value(const Value& v);
 
@@ -39,27 +41,31 @@ public:
 
    ~Value();
 
-   Type *type() const { return (_box == 0 ? 0 : _box->type); }
-   void *data()       { return (_box == 0 ? 0 : _box->data); }
+   Type *type() const { return (_box == 0 ? 0 : _place ? _place_type() : _box->type); }
+   void *data()  const { return (_box == 0 ? 0 : _place ? (void*)_box : _box->data); }
 
    template<typename T> bool is() const;
    template<typename T> typename T::cpp_type& as() const;
-   bool has_type(const Type *t) const { return _box->type == t; }
+   bool has_type(const Type *t) const { return type() == t; }
 
    static Value null;
    bool is_null() const { return _box == 0; }
 
+   static long allocations; // Boxes and basic-type payloads created so far
+
    std::string type_name() const;
 
    bool same_type_as(const Value& v) const { 
-      return _box->type == v._box->type; 
+      return type() == v.type(); 
    }
    
    // This means "it is the same object" (the same Box), like in Java
    const bool operator==(const Value& v) const {
-      return _box == v._box;
+      return _box == v._box and _place == v._place;
    }
    bool equals(const Value& v) const; // Comparison of data
+   bool less(const Value& v) const;   // Ordering of data (consistent with equals)
+   size_t hash() const;               // Hash of data (consistent with equals)
 
    const Value& operator=(const Value& v); // copies reference, not Box!
    bool assign(const Value& v); // copies content of Box
@@ -72,6 +78,10 @@ public:
    friend class Reference;
 };
 
+struct ValueLess {
+   bool operator()(const Value& a, const Value& b) const { return a.less(b); }
+};
+
 std::ostream& operator<<(std::ostream& o, const Value& v);
 std::istream& operator>>(std::istream& o, Value& v);
 
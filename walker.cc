@@ -108,6 +108,19 @@ void Walker::visit_iterstmt(IterStmt *x) {
    x->substmt->accept(this);
 }
 
+void Walker::visit_switchstmt(SwitchStmt *x) {
+   walk(x);
+   x->cond->accept(this);
+   for (SwitchStmt::Case& c : x->cases) {
+      if (c.label) {
+         c.label->accept(this);
+      }
+      for (Stmt *s : c.stmts) {
+         s->accept(this);
+      }
+   }
+}
+
 void Walker::visit_callexpr(CallExpr *x) {
    walk(x);
    x->func->accept(this);
@@ -167,7 +180,97 @@ void Walker::visit_derefexpr(DerefExpr *x) {
    x->expr->accept(this);
 }
 
+void Walker::visit_newexpr(NewExpr *x) {
+   walk(x);
+   x->typespec->accept(this);
+   if (x->size) {
+      x->size->accept(this);
+   }
+   if (x->init) {
+      x->init->accept(this);
+   }
+}
+
+void Walker::visit_deleteexpr(DeleteExpr *x) {
+   walk(x);
+   x->expr->accept(this);
+}
+
 void Walker::visit_paramdecl(ParamDecl *x) {
    walk(x);
    x->typespec->accept(this);
-}
\ No newline at end of file
+}
+
+void NodeCollector::walk(AstNode *x) {
+   if (_seen.insert(x).second) {
+      nodes.push_back(x);
+   }
+}
+
+void NodeCollector::visit_typespec(TypeSpec *x) {
+   walk(x);
+   _accept(x->id);
+}
+
+void NodeCollector::visit_declstmt(DeclStmt *x) {
+   walk(x);
+   _accept(x->typespec);
+   for (DeclStmt::Item item : x->items) {
+      _accept(item.decl);
+      _accept(item.init);
+   }
+}
+
+void NodeCollector::visit_ident(Ident *x) {
+   walk(x);
+   for (TypeSpec *t : x->subtypes) {
+      _accept(t);
+   }
+   for (Ident *id : x->prefix) {
+      _accept(id);
+   }
+}
+
+void NodeCollector::visit_funcdecl(FuncDecl *x) {
+   Walker::visit_funcdecl(x);
+   _accept(x->id);
+}
+
+void NodeCollector::visit_vardecl(VarDecl *x) {
+   walk(x);
+   _accept(x->typespec);
+}
+
+void NodeCollector::visit_arraydecl(ArrayDecl *x) {
+   walk(x);
+   _accept(x->typespec);
+   _accept(x->size);
+   for (Expr *e : x->subsizes) {
+      _accept(e);
+   }
+}
+
+void NodeCollector::visit_objdecl(ObjDecl *x) {
+   walk(x);
+   _accept(x->typespec);
+   for (Expr *e : x->args) {
+      _accept(e);
+   }
+}
+
+void delete_tree(AstNode *x) {
+   if (x == 0) {
+      return;
+   }
+   NodeCollector C;
+   x->accept(&C);
+   for (AstNode *n : C.nodes) {
+      for (Error *e : n->errors) {
+         delete e;
+      }
+      for (CommentSeq *c : n->comments) {
+         delete c;
+      }
+      delete n;
+   }
+}
@@ -3,6 +3,7 @@
 
 #include <assert.h>
 #include <iostream>
+#include <set>
 #include "ast.hh"
 
 class Walker : public AstVisitor, public ReadWriter {
@@ -32,6 +33,7 @@ public:
    void visit_exprstmt(ExprStmt *x);
    void visit_ifstmt(IfStmt *x);
    void visit_iterstmt(IterStmt *x);
+   void visit_switchstmt(SwitchStmt *x);
    void visit_jumpstmt(JumpStmt *x);
    void visit_callexpr(CallExpr *x);
    void visit_indexexpr(IndexExpr *x);
@@ -43,6 +45,8 @@ public:
    void visit_negexpr(NegExpr *x);
    void visit_addrexpr(AddrExpr *x);
    void visit_derefexpr(DerefExpr *x);
+   void visit_newexpr(NewExpr *x);
+   void visit_deleteexpr(DeleteExpr *x);
    void visit_paramdecl(ParamDecl *x);
 
    void visit_errorstmt(Stmt::Error *x);
@@ -67,4 +71,31 @@ inline void collect_errors(AstNode *x, std::vector<Error*>& v) {
    }
 }
 
+// Every node of a tree, once (the items of a declaration share its
+// TypeSpec), including those the Walker doesn't go into, and also those
+// of a declaration the parser gave up on (with parts missing)
+class NodeCollector : public Walker {
+   std::set<AstNode*> _seen;
+
+   void _accept(AstNode *x) {
+      if (x != 0) {
+         x->accept(this);
+      }
+   }
+
+public:
+   std::vector<AstNode*> nodes;
+
+   void walk(AstNode *n);
+   void visit_typespec(TypeSpec *x);
+   void visit_declstmt(DeclStmt *x);
+   void visit_ident(Ident *x);
+   void visit_funcdecl(FuncDecl *x);
+   void visit_vardecl(VarDecl *x);
+   void visit_arraydecl(ArrayDecl *x);
+   void visit_objdecl(ObjDecl *x);
+};
+
+void delete_tree(AstNode *x); // with its errors and comments
+
 #endif
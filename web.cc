@@ -8,19 +8,19 @@ using namespace std;
 #include <emscripten/bind.h>
 
 #include "parser.hh"
+#include "reparser.hh"
 #include "walker.hh"
 #include "prettypr.hh"
 #include "stepper.hh"
 #include "interpreter.hh"
 #include "translator.hh"
 
+// The editor compiles after every change, so the tree is kept and only
+// the part that changed is parsed again
+Reparser reparser;
 AstNode *program;
 
-string compile(string code) {
-   istringstream S(code);
-   Parser P(&S);
-   program = P.parse();
-
+string error_messages() {
    ostringstream E;
    vector<Error*> errors;
    collect_errors(program, errors);
@@ -30,6 +30,16 @@ string compile(string code) {
    return E.str();
 }
 
+string compile(string code) {
+   program = reparser.update(code);
+   return error_messages();
+}
+
+string edit(int first, int last, string text) {
+   program = reparser.edit(first, last, text);
+   return error_messages();
+}
+
 string execute(string input) {
    istringstream in(input);
    ostringstream out;
@@ -52,6 +62,7 @@ string reformat(string code) {
    ostringstream out;
    PrettyPrinter pr(&out);
    prog->visit(&pr);
+   delete_tree(prog);
    return out.str();
 }
 
@@ -72,6 +83,7 @@ public:
 
 EMSCRIPTEN_BINDINGS(minicc) {
    emscripten::function("compile", &compile);
+   emscripten::function("edit", &edit);
    emscripten::function("execute", &execute);
    emscripten::function("reformat", &reformat);
    emscripten::class_<Pos>("Pos")